@@ -0,0 +1,124 @@
+// Throughput harness: decodes the captures under data/ (or the passed directories/files) from memory,
+// without SDL and without real-time pacing, and reports decoding speed and memory usage.
+
+#include "DataDispatcher.h"
+#include "DataSource.h"
+#include "FrameDecoder.h"
+#include "InMemoryCapture.h"
+#include "VisualizerConfiguration.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+namespace {
+
+const int REPETITIONS = 5;
+
+// Settings as documented in the README examples. The file names of the bundled captures describe the channel mapping.
+auto getVisualizerConfiguration(const std::filesystem::path& path) -> VisualizerConfiguration {
+  VisualizerConfiguration config;
+  config.highlightVSync = true;
+  config.highlightHSync = true;
+  const auto name = path.filename().string();
+  if (name.find("red_2_green_3_blue4") != std::string::npos) {
+    config.dataGreenChannel = 3;
+    config.dataBlueChannel = 4;
+  }
+  if (name.find("z1013") != std::string::npos) {
+    config.invertData = true;
+  }
+
+  return config;
+}
+
+auto getPeakRssKiB() -> long {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss; // KiB on Linux
+}
+
+auto benchmark(const std::filesystem::path& path) -> void {
+  DataSourceConfiguration dataSourceConfig;
+  dataSourceConfig.inputFile = path.string();
+  InMemoryCapture<Sample> capture(dataSourceConfig);
+  const auto samples = capture.getSamples();
+  const auto sampleRate = capture.getSampleRate();
+  auto config = getVisualizerConfiguration(path);
+  config.sampleRate = sampleRate;
+
+  std::vector<Pixel> frame(static_cast<size_t>(config.width) * config.height);
+  const size_t blockSize = 64 * 1024; // typical size of libsigrok logic packets
+  double bestSeconds = 0;
+  uint64_t frames = 0;
+
+  for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+    frames = 0;
+    FrameDecoder<Sample> frameDecoder(config, [&frames]() { frames++; });
+    frameDecoder.setTarget(frame.data());
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < samples.size(); offset += blockSize) {
+      frameDecoder.decode(samples.subspan(offset, std::min(blockSize, samples.size() - offset)));
+    }
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    if (repetition == 0 || duration.count() < bestSeconds) {
+      bestSeconds = duration.count();
+    }
+  }
+
+  const auto sampleCount = static_cast<double>(samples.size());
+  const double samplesPerSecond = sampleCount / bestSeconds;
+  std::cout << path.filename().string() << std::endl
+            << std::fixed << std::setprecision(2)
+            << "  samples:      " << samples.size() << " @ " << static_cast<double>(sampleRate) / 1e6 << " MHz" << std::endl
+            << "  throughput:   " << samplesPerSecond / 1e6 << " MSamples/s (" << samplesPerSecond / static_cast<double>(sampleRate) << "x real time)" << std::endl
+            << "  per sample:   " << std::setprecision(3) << bestSeconds * 1e9 / sampleCount << " ns" << std::endl
+            << "  frames:       " << std::setprecision(1) << static_cast<double>(frames) / bestSeconds << " frames/s (" << frames << " frames)" << std::endl
+            << "  peak RSS:     " << getPeakRssKiB() / 1024 << " MiB" << std::endl;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+  std::vector<std::filesystem::path> arguments(argv + 1, argv + argc);
+  if (arguments.empty()) {
+    arguments.emplace_back("data");
+  }
+
+  std::vector<std::filesystem::path> captures;
+  for (const auto& argument : arguments) {
+    if (std::filesystem::is_directory(argument)) {
+      for (const auto& entry : std::filesystem::recursive_directory_iterator(argument)) {
+        if (entry.path().extension() == ".sr" || entry.path().extension() == ".vgc") {
+          captures.push_back(entry.path());
+        }
+      }
+    } else {
+      captures.push_back(argument);
+    }
+  }
+  std::sort(captures.begin(), captures.end());
+
+  if (captures.empty()) {
+    std::cerr << "No captures found. Usage: vidgrok-bench [directory or .sr/.vgc file...]" << std::endl;
+    return 1;
+  }
+
+  try {
+    for (const auto& capture : captures) {
+      benchmark(capture);
+    }
+  } catch (std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
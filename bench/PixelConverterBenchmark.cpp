@@ -0,0 +1,167 @@
+// Microbenchmark for the sample-to-pixel conversion: compares the former per-sample scalar path
+// (configuration flags evaluated for every sample) with the lookup table kernels.
+
+#include "PixelConverter.h"
+#include "VisualizerConfiguration.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Per-sample evaluation as done by DataVisualizer before the lookup table was introduced (one bit per color)
+template <typename T>
+class ReferenceConverter final {
+public:
+  explicit ReferenceConverter(const VisualizerConfiguration& config)
+    : mConfig(config),
+      vSyncChannelMask(1 << config.vSyncChannel),
+      hSyncChannelMask(1 << config.hSyncChannel),
+      dataRedChannelMask(1 << config.dataRedChannel),
+      dataGreenChannelMask(1 << config.dataGreenChannel),
+      dataBlueChannelMask(1 << config.dataBlueChannel) {
+  }
+
+  auto convert(std::span<const T> samples, Pixel* pixels) const -> void {
+    for (size_t i = 0; i < samples.size(); i++) {
+      const T data = samples[i];
+      bool vSyncActive = mConfig.invertVSync == (data & vSyncChannelMask);
+      bool hSyncActive = mConfig.invertHSync == (data & hSyncChannelMask);
+      Pixel value = 0;
+      if (mConfig.highlightVSync && vSyncActive) {
+        value |= 0x3f0000ff;
+      }
+      if (mConfig.highlightHSync && hSyncActive) {
+        value |= 0x00003fff;
+      }
+      if ((!vSyncActive && !hSyncActive) || mConfig.renderHiddenData) {
+        value |= ((bool)(data & dataRedChannelMask) != mConfig.invertData) ? 0xff0000ff : 0x00000000;
+        value |= ((bool)(data & dataGreenChannelMask) != mConfig.invertData) ? 0x00ff00ff : 0x00000000;
+        value |= ((bool)(data & dataBlueChannelMask) != mConfig.invertData) ? 0x0000ffff : 0x00000000;
+      }
+      pixels[i] = value;
+    }
+  }
+
+private:
+  const VisualizerConfiguration& mConfig;
+  const T vSyncChannelMask;
+  const T hSyncChannelMask;
+  const T dataRedChannelMask;
+  const T dataGreenChannelMask;
+  const T dataBlueChannelMask;
+};
+
+// Lines of 768 samples: sync pulse, blanking, then pixel data (bits of dataMask) with runs of random length
+template <typename T>
+auto createVideoLikeSamples(size_t count, unsigned int maxRunLength, T dataMask) -> std::vector<T> {
+  std::mt19937 random(42);
+  std::vector<T> samples(count);
+  T data = 0;
+  unsigned int runLeft = 0;
+  for (size_t i = 0; i < count; i++) {
+    const auto column = i % 768;
+    if (column < 64) {
+      samples[i] = 0b00000010; // hsync
+    } else if (column < 160) {
+      samples[i] = 0b00000000; // blanking
+    } else {
+      if (runLeft == 0) {
+        data = static_cast<T>(random() & dataMask);
+        runLeft = 1 + random() % maxRunLength;
+      }
+      runLeft--;
+      samples[i] = data;
+    }
+  }
+
+  return samples;
+}
+
+// Returns samples per second
+auto measure(size_t sampleCount, const std::function<void()>& convert) -> double {
+  const int repetitions = 20;
+  convert(); // warm-up
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; i++) {
+    convert();
+  }
+  const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+  return static_cast<double>(sampleCount) * repetitions / duration.count();
+}
+
+auto report(const std::string& name, double samplesPerSecond, double referenceRate) -> void {
+  std::cout << "  " << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1) << std::setw(10) << samplesPerSecond / 1e6 << " MSamples/s" << std::setprecision(2) << std::setw(8) << samplesPerSecond / referenceRate << "x";
+}
+
+// Compares all kernels with the reference (or the scalar kernel for more than one bit per color)
+template <typename T>
+auto compareKernels(const VisualizerConfiguration& config, T dataMask) -> void {
+  using Converter = PixelConverter<T>;
+  const size_t sampleCount = 16 * 1024 * 1024;
+  std::vector<Pixel> pixels(sampleCount);
+
+  for (unsigned int maxRunLength : {1U, 8U, 64U}) {
+    const auto samples = createVideoLikeSamples<T>(sampleCount, maxRunLength, dataMask);
+    std::cout << "Data runs of 1.." << maxRunLength << " samples:" << std::endl;
+
+    double referenceRate = 0;
+    if (config.colorDepth == 1) {
+      ReferenceConverter<T> reference(config);
+      referenceRate = measure(samples.size(), [&]() { reference.convert(samples, pixels.data()); });
+      report("reference", referenceRate, referenceRate);
+      std::cout << std::endl;
+    } else {
+      Converter reference(config, Converter::Kernel::Scalar);
+      referenceRate = measure(samples.size(), [&]() { reference.convert(samples, pixels.data()); });
+    }
+    const auto expected = pixels;
+
+    for (auto kernel : {Converter::Kernel::Scalar, Converter::Kernel::Sse2, Converter::Kernel::Avx2, Converter::Kernel::Bmi2}) {
+      if (!Converter::isSupported(kernel)) {
+        std::cout << "  " << Converter::getKernelName(kernel) << ": not supported" << std::endl;
+        continue;
+      }
+      Converter converter(config, kernel);
+      const double rate = measure(samples.size(), [&]() { converter.convert(samples, pixels.data()); });
+      report(Converter::getKernelName(kernel), rate, referenceRate);
+      std::cout << (pixels == expected ? "" : " (OUTPUT MISMATCH!)") << std::endl;
+    }
+  }
+}
+
+} // namespace
+
+auto main() -> int {
+  VisualizerConfiguration config;
+  config.dataRedChannel = 2;
+  config.dataGreenChannel = 3;
+  config.dataBlueChannel = 4;
+  config.highlightVSync = true;
+  config.highlightHSync = true;
+
+  std::cout << "8 bit samples, RGB on channels 2, 3 and 4" << std::endl;
+  compareKernels<Sample>(config, 0b00011100);
+
+  std::cout << std::endl << "16 bit samples, RGB on channels 10, 11 and 12" << std::endl;
+  config.dataRedChannel = 10;
+  config.dataGreenChannel = 11;
+  config.dataBlueChannel = 12;
+  compareKernels<WideSample>(config, 0b0001110000000000);
+
+  std::cout << std::endl << "16 bit samples, 4 bits per color on channels 13-10, 9-6 and 5-2 (relative to scalar)" << std::endl;
+  config.dataRedChannel = 13;
+  config.dataGreenChannel = 9;
+  config.dataBlueChannel = 5;
+  config.colorDepth = 4;
+  compareKernels<WideSample>(config, 0b0011111111111100);
+
+  return 0;
+}
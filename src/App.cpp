@@ -1,41 +1,344 @@
 #include "App.h"
+#include "CapturePlayer.h"
 #include "DataDispatcher.h"
 #include "DataSource.h"
 #include "DataVisualizer.h"
+#include "FrameAccumulator.h"
+#include "FrameExporter.h"
+#include "FrameIndex.h"
+#include "FrameServer.h"
+#include "FrameViewer.h"
+#include "InMemoryCapture.h"
+#include "NativeCaptureWriter.h"
+#include "ParallelFrameExporter.h"
+#include "SampleRecorder.h"
+#include "SignalAnalyzer.h"
+#include "Statistics.h"
+#include "StatisticsReporter.h"
+#include "StreamDecoder.h"
+#include "StreamRecorder.h"
+#include "ThreadAffinity.h"
+#include "VideoModeDetector.h"
+#include "ZoomViewer.h"
+#include <algorithm>
 #include <cxxopts.hpp>
 #include <exception>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 auto App::run(int argc, char** argv) -> int {
   try {
+    // Subcommand: the remaining arguments are the usual options
+    if (argc > 1 && std::string(argv[1]) == "analyze") {
+      analyze = true;
+      argv[1] = argv[0];
+      argc--;
+      argv++;
+    }
     if (!processOptions(argc, argv)) {
       return 0; // help has been displayed
     }
 
-    SampleDataDispatcher dataDispatcher;
+    if (connectAddress) {
+      FrameViewer viewer(connectAddress.value());
+      viewer.run(); // main loop
+      return 0;
+    }
+
+    // Samples are only widened when channels above 7 are used, 8 bit samples are faster to decode.
+    if (wideSamples) {
+      runPipeline<WideSample>();
+    } else {
+      runPipeline<Sample>();
+    }
+  } catch (std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+template <typename T>
+auto App::runPipeline() -> void {
+  if (analyze) {
+    analyzeStream<T>();
+    return;
+  }
 
-    auto dataSource = DataSource::create(dataDispatcher, dataSourceConfig);
+  if (visualizerConfig.autoMode) {
+    detectVideoMode<T>();
+  }
 
-    visualizerConfig.sampleRate = dataSource->getSampleRate();
+  if (seekable) {
+    playCapture<T>();
+    return;
+  }
 
-    DataVisualizer visualizer(dataDispatcher, visualizerConfig);
+  if (zoom) {
+    zoomCapture<T>();
+    return;
+  }
 
-    std::thread dataSourceThread([&dataSource]() {
-      dataSource->run(); // main loop of data source
+  if (visualizerConfig.headless && visualizerConfig.decodeThreads > 1) {
+    InMemoryCapture<T> capture(dataSourceConfigs.at(0));
+    visualizerConfig.sampleRate = capture.getSampleRate();
+    ParallelFrameExporter<T> exporter(capture, visualizerConfig, visualizerConfig.decodeThreads);
+    exporter.run();
+    return;
+  }
+
+  // Every stream has its own dispatcher, data source thread and decoder; they only share the output.
+  std::vector<Stream<T>> streams(dataSourceConfigs.size());
+  for (size_t i = 0; i < streams.size(); i++) {
+    streams[i].visualizerConfig = visualizerConfig;
+    if (i < outputPaths.size()) {
+      streams[i].visualizerConfig.outputPath = outputPaths[i];
+    }
+    // Recorded sessions can wait for the visualizer, live hardware must never be stalled.
+    streams[i].dataDispatcher = std::make_unique<DataDispatcher<T>>(
+      DataDispatcher<T>::DEFAULT_SLOT_COUNT,
+      dataSourceConfigs[i].inputFile ? DataDispatcher<T>::OverflowPolicy::Block : DataDispatcher<T>::OverflowPolicy::Drop,
+      std::max(dataSourceConfigs[i].coalesceBytes, SampleArena<T>::DEFAULT_BLOCK_BYTES),
+      dataSourceConfigs[i].hugePages
+    );
+  }
+  auto& dataDispatcher = *streams[0].dataDispatcher; // statistics, recording and conversion only work with one stream
+
+  // Instrumentation is only wired in when requested, the hot path then just checks a null pointer.
+  std::optional<Statistics> statistics;
+  if (statisticsEnabled) {
+    statistics.emplace(dataDispatcher);
+  }
+  Statistics* statisticsPointer = statistics ? &statistics.value() : nullptr;
+  std::optional<StatisticsReporter> statisticsReporter;
+  if (statisticsPath) {
+    statisticsReporter.emplace(statistics.value(), statisticsPath.value(), statisticsInterval);
+  }
+
+  // Live captures can be recorded while being visualized
+  std::optional<StreamRecorder<T>> streamRecorder;
+  if (recordPath) {
+    streamRecorder.emplace(recordPath.value());
+  }
+
+  for (size_t i = 0; i < streams.size(); i++) {
+    streams[i].dataSource = DataSource<T>::create(*streams[i].dataDispatcher, dataSourceConfigs[i], statisticsPointer, streamRecorder ? &streamRecorder->getDataDispatcher() : nullptr);
+    streams[i].visualizerConfig.sampleRate = streams[i].dataSource->getSampleRate();
+  }
+  visualizerConfig.sampleRate = streams[0].visualizerConfig.sampleRate;
+  auto& dataSource = streams[0].dataSource;
+  if (streamRecorder) {
+    streamRecorder->start(dataSource->getSampleRate(), dataSource->getChannelNames(), visualizerConfig.vSyncChannel, visualizerConfig.invertVSync);
+  }
+
+  for (auto& stream : streams) {
+    stream.dataSourceThread = std::thread([&stream]() {
+      stream.dataSource->run(); // main loop of data source
     });
+  }
+  auto stopStreams = [&streams]() {
+    for (auto& stream : streams) {
+      stream.dataDispatcher->close();
+      stream.dataSourceThread.join();
+    }
+  };
 
-    visualizer.run(); // main loop
+  try {
+    if (convertPath) {
+      NativeCaptureWriter<T> writer(convertPath.value(), dataSource->getSampleRate(), dataSource->getChannelNames(), visualizerConfig.vSyncChannel, visualizerConfig.invertVSync);
+      SampleRecorder<T> recorder(dataDispatcher, writer);
+      recorder.run(); // main loop
+    } else if (visualizerConfig.headless && streams.size() == 1) {
+      FrameExporter<T> exporter(dataDispatcher, streams[0].visualizerConfig, statisticsPointer);
+      exporter.run(); // main loop
+    } else if (visualizerConfig.headless) {
+      exportStreams(streams);
+    } else if (serveAddress) {
+      FrameServer<T> server(std::make_unique<StreamDecoder<T>>(dataDispatcher, streams[0].visualizerConfig, statisticsPointer), visualizerConfig, serveAddress.value(), statisticsPointer);
+      server.run(); // main loop
+    } else {
+      // In auto mode, the visualizer stops when the video mode changes and is set up again for the new one. The data
+      // sources keep running meanwhile.
+      std::optional<VideoMode> changedVideoMode;
+      do {
+        if (changedVideoMode) {
+          applyVideoMode(changedVideoMode.value());
+          streams[0].visualizerConfig = visualizerConfig;
+        }
+        std::vector<std::unique_ptr<StreamDecoder<T>>> streamDecoders;
+        for (auto& stream : streams) {
+          streamDecoders.push_back(std::make_unique<StreamDecoder<T>>(*stream.dataDispatcher, stream.visualizerConfig, statisticsPointer));
+        }
+        DataVisualizer<T> visualizer(std::move(streamDecoders), visualizerConfig, statisticsPointer);
+        changedVideoMode = visualizer.run(); // main loop
+      } while (changedVideoMode);
+    }
+  } catch (std::exception& e) {
+    stopStreams();
+    throw;
+  }
+
+  stopStreams();
+
+  if (streamRecorder) {
+    streamRecorder->stop();
+    std::cerr << "Recorded " << streamRecorder->getRecordedSampleCount() << " samples to " << recordPath.value() << "." << std::endl;
+    if (streamRecorder->getDroppedBlockCount() > 0) {
+      std::cerr << "Warning: " << streamRecorder->getDroppedBlockCount() << " packets are missing in the recording because writing was too slow." << std::endl;
+    }
+  }
+
+  for (size_t i = 0; i < streams.size(); i++) {
+    const auto& streamDispatcher = *streams[i].dataDispatcher;
+    if (streamDispatcher.getOverrunCount() > 0) {
+      std::cerr << "Warning: " << (streams.size() > 1 ? "Stream " + std::to_string(i) + ": " : "") << streamDispatcher.getOverrunCount() << " packets dropped because rendering was too slow (buffer high-water mark: " << streamDispatcher.getHighWaterMark() << "/" << streamDispatcher.getCapacity() << ")." << std::endl;
+    }
+  }
+}
+
+// The whole capture is held in memory (native captures are memory-mapped) and played by the decoder thread at the
+// position and speed requested in the window.
+template <typename T>
+auto App::playCapture() -> void {
+  InMemoryCapture<T> capture(dataSourceConfigs.at(0));
+  visualizerConfig.sampleRate = capture.getSampleRate();
+  const auto samples = capture.getSamples();
+  FrameIndex<T> frameIndex(samples, visualizerConfig.vSyncChannel, visualizerConfig.invertVSync, dataSourceConfigs[0].inputFile.value(), capture.getNativeCapture());
+  CapturePlayer<T> player(samples, frameIndex, visualizerConfig.sampleRate, dataSourceConfig.keepGoing);
+  if (startFrame > 0) {
+    player.seek(startFrame);
+  }
+
+  std::vector<std::unique_ptr<StreamDecoder<T>>> streamDecoders;
+  streamDecoders.push_back(std::make_unique<StreamDecoder<T>>(player, visualizerConfig));
+  DataVisualizer<T> visualizer(std::move(streamDecoders), visualizerConfig);
+  visualizer.run(); // main loop
+}
+
+// Like seekable playback, but the frame is not decoded: the view reads only the samples it shows, through a summary
+// pyramid of the capture (built once after loading).
+template <typename T>
+auto App::zoomCapture() -> void {
+  InMemoryCapture<T> capture(dataSourceConfigs.at(0));
+  visualizerConfig.sampleRate = capture.getSampleRate();
+  const auto samples = capture.getSamples();
+  FrameIndex<T> frameIndex(samples, visualizerConfig.vSyncChannel, visualizerConfig.invertVSync, dataSourceConfigs[0].inputFile.value(), capture.getNativeCapture());
+  std::cerr << "Summarizing " << samples.size() << " samples..." << std::endl;
+  const SamplePyramid<T> pyramid(samples);
+
+  ZoomViewer<T> viewer(samples, pyramid, frameIndex, visualizerConfig);
+  viewer.run(startFrame); // main loop
+}
+
+// Metrics instead of pictures, the data source is the same as for visualizing. Live captures must never be stalled, so
+// blocks are dropped (and reported) when the analysis can't keep up.
+template <typename T>
+auto App::analyzeStream() -> void {
+  const auto& config = dataSourceConfigs.at(0);
+  DataDispatcher<T> dataDispatcher(
+    DataDispatcher<T>::DEFAULT_SLOT_COUNT,
+    config.inputFile ? DataDispatcher<T>::OverflowPolicy::Block : DataDispatcher<T>::OverflowPolicy::Drop,
+    std::max(config.coalesceBytes, SampleArena<T>::DEFAULT_BLOCK_BYTES),
+    config.hugePages
+  );
+  auto dataSource = DataSource<T>::create(dataDispatcher, config);
+  visualizerConfig.sampleRate = dataSource->getSampleRate();
+  const std::vector<uint8_t> channels(config.enabledChannels.begin(), config.enabledChannels.end());
+  SignalAnalyzer<T> analyzer(dataDispatcher, visualizerConfig, channels, analysisFormat, outputPaths.empty() ? "-" : outputPaths.front());
+
+  std::thread dataSourceThread([&dataSource]() {
+    dataSource->run(); // main loop of data source
+  });
+  try {
+    analyzer.run(); // main loop
+  } catch (...) {
     dataDispatcher.close();
     dataSourceThread.join();
+    throw;
+  }
+  dataDispatcher.close();
+  dataSourceThread.join();
 
-  } catch (std::exception& e) {
-    std::cerr << "Error: " << e.what() << std::endl;
-    return 1;
+  std::cerr << "Analyzed " << analyzer.getFrameCount() << " frames." << std::endl;
+  if (dataDispatcher.getOverrunCount() > 0) {
+    std::cerr << "Warning: " << dataDispatcher.getOverrunCount() << " packets dropped because the analysis was too slow." << std::endl;
   }
+}
 
-  return 0;
+// Headless mode with several streams: one exporter thread per stream (spread over the cores), each writing to its
+// own output. A failing stream doesn't stop the others.
+template <typename T>
+auto App::exportStreams(std::vector<Stream<T>>& streams) -> void {
+  std::vector<std::exception_ptr> exceptions(streams.size());
+  std::vector<std::thread> exporterThreads;
+  for (size_t i = 0; i < streams.size(); i++) {
+    exporterThreads.emplace_back([&stream = streams[i], &exception = exceptions[i]]() {
+      try {
+        FrameExporter<T> exporter(*stream.dataDispatcher, stream.visualizerConfig);
+        exporter.run(); // main loop
+      } catch (...) {
+        exception = std::current_exception();
+        stream.dataDispatcher->close();
+      }
+    });
+    pinThreadToCore(exporterThreads.back(), static_cast<unsigned int>(i + 1));
+  }
+  for (auto& exporterThread : exporterThreads) {
+    exporterThread.join();
+  }
+  for (const auto& exception : exceptions) {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+}
+
+// Separate pass over the beginning of the stream (input files are read again from the start afterwards, live captures
+// continue with fresh samples).
+template <typename T>
+auto App::detectVideoMode() -> void {
+  DataDispatcher<T> detectionDispatcher(
+    DataDispatcher<T>::DEFAULT_SLOT_COUNT,
+    dataSourceConfigs[0].inputFile ? DataDispatcher<T>::OverflowPolicy::Block : DataDispatcher<T>::OverflowPolicy::Drop,
+    std::max(dataSourceConfigs[0].coalesceBytes, SampleArena<T>::DEFAULT_BLOCK_BYTES),
+    dataSourceConfigs[0].hugePages
+  );
+  auto detectionSource = DataSource<T>::create(detectionDispatcher, dataSourceConfigs[0]);
+  visualizerConfig.sampleRate = detectionSource->getSampleRate();
+  std::thread detectionSourceThread([&detectionSource]() {
+    detectionSource->run();
+  });
+
+  VideoModeDetector<T> detector(visualizerConfig);
+  const auto maxSampleCount = visualizerConfig.sampleRate * MAX_DETECTION_SECONDS;
+  while (!detector.isComplete() && detector.getAnalyzedSampleCount() < maxSampleCount) {
+    auto optionalData = detectionDispatcher.get(std::chrono::milliseconds(100));
+    if (optionalData) {
+      detector.scan(optionalData.value());
+      detectionDispatcher.clear();
+    } else if (detectionDispatcher.isClosed()) {
+      break; // end of data
+    }
+  }
+  detectionDispatcher.close();
+  detectionSourceThread.join();
+
+  if (!detector.isComplete()) {
+    throw std::runtime_error("Unable to detect the video mode (--auto-mode). Check the sync channels and the sample rate.");
+  }
+  applyVideoMode(detector.getVideoMode());
+}
+
+auto App::applyVideoMode(const VideoMode& videoMode) -> void {
+  videoMode.apply(visualizerConfig);
+  std::cerr << "Video mode: " << videoMode.toString(visualizerConfig.sampleRate) << std::endl;
 }
 
 auto App::processOptions(int argc, char** argv) -> bool {
@@ -49,20 +352,49 @@ auto App::processOptions(int argc, char** argv) -> bool {
   addOption("height", "Window height", value<int>()->default_value(to_string(visualizerConfig.height)));
   addOption("vsync", "Vertical sync channel number", value<uint8_t>()->default_value(to_string(visualizerConfig.vSyncChannel)));
   addOption("hsync", "Horizontal sync channel number", value<uint8_t>()->default_value(to_string(visualizerConfig.hSyncChannel)));
-  addOption("data", "Data channel number(s). Either a single digit for monochrome or 3 digits for 8 bit RGB-color (e.g. --data 2 or --data 234) ", value<std::string>()->default_value(to_string(visualizerConfig.dataRedChannel)));
+  addOption("data", "Data channel number(s). Either a single digit for monochrome or 3 digits for 8 bit RGB-color (e.g. --data 2 or --data 234). For channels above 9 or more bits per color, pass red, green and blue separated by commas, each a channel or a range from most to least significant channel (e.g. --data 10,11,12 or --data 11-8,7-4,3-0)", value<std::string>()->default_value(to_string(visualizerConfig.dataRedChannel)));
   addOption("invert-data", "Invert data channel input", value<bool>());
   addOption("invert-vsync", "Invert vertical sync channel input", value<bool>());
   addOption("invert-hsync", "Invert horizontal sync channel input", value<bool>());
   addOption("no-vsync", "Disable vertical synchronisation", value<bool>());
   addOption("no-hsync", "Disable horizontal synchronisation", value<bool>());
+  addOption("csync", "Horizontal sync channel carries composite sync; horizontal and vertical sync are separated in software (no LM1881 needed, --vsync is not used)", value<bool>());
   addOption("highlight-vsync", "Visualize vertical synchronisation", value<bool>());
   addOption("highlight-hsync", "Visualize horizontal synchronisation", value<bool>());
   addOption("hidden-data", "Render (hidden) data in blanking areas", value<bool>());
+  addOption("decimate", "Number of samples per pixel (horizontally), reduces work and texture size at high sample rates", value<unsigned int>()->default_value(to_string(visualizerConfig.decimation)));
+  addOption("box-filter", "Average the samples of a pixel when decimating instead of picking the first one", value<bool>());
+  addOption("line-pixels", "Resample every line (sync to sync) to this number of pixels, independent of the sample rate (area average, instead of --decimate)", value<unsigned int>()->default_value(to_string(visualizerConfig.linePixels)));
+  addOption("crop-left", "Number of samples after horizontal sync to skip (the window then shows --width pixels from there)", value<long int>()->default_value(to_string(visualizerConfig.cropLeft)));
+  addOption("crop-top", "Number of lines after vertical sync to skip (the window then shows --height lines from there)", value<long int>()->default_value(to_string(visualizerConfig.cropTop)));
   addOption("render-synced", "Render image only on vertical syncs", value<bool>());
+  addOption("persistence", "Blend completed frames against flicker of noisy signals: decay (exponential), average (of the last frames) or max (hold the brightest value)", value<std::string>());
+  addOption("persistence-frames", "Time constant of --persistence decay (rounded to a power of two) or number of frames of --persistence average", value<unsigned int>()->default_value(to_string(visualizerConfig.persistenceFrames)));
+  addOption("sync-lock", "Learn line and frame timing from the sync signals, reject noise pulses and replace missing ones (for noisy signals)", value<bool>());
+  addOption("auto-mode", "Detect sync polarities, crop window and size from the first frames (overrides --invert-hsync, --invert-vsync, --crop-left, --crop-top, --width and --height). The window follows later mode changes.", value<bool>());
+  addOption("headless", "Decode without window and as fast as possible, writing every frame to --output", value<bool>());
+  addOption("o,output", "Frame output for --headless: PPM sequence when containing a frame number placeholder (e.g. frame_%05d.ppm), otherwise raw RGBA stream (- for stdout). Pass one per stream when capturing several.", value<std::vector<std::string>>());
+  addOption("skip-unchanged", "Don't write frames that are identical to the previous one in --headless mode (image sequences keep the frame numbers, leaving gaps)", value<bool>());
   addOption("s,sample-rate", "Sample rate in Hz", value<uint64_t>()->default_value(to_string(dataSourceConfig.sampleRate)));
   addOption("d,driver", "libsigrok capturing driver to use. First encountered non-demo device is used by default.", value<std::string>()); // example: fx2lafw
-  addOption("i,input-file", "Load recorded session (Pulseview/sigrok-cli) instead of using device directly", value<std::string>());
+  addOption("device", "Index of the logic analyzer to use among the ones found (of --driver). Repeat to capture from several devices at the same time.", value<std::vector<unsigned int>>());
+  addOption("i,input-file", "Load recorded session (Pulseview/sigrok-cli) instead of using device directly. Repeat to show several sessions at the same time.", value<std::vector<std::string>>());
+  addOption("coalesce", "Collect the packets of the driver into blocks of this many bytes before decoding them (0: decode every packet as it is). Spreads the costs per packet of drivers delivering many small ones.", value<size_t>()->default_value(to_string(dataSourceConfig.coalesceBytes)));
+  addOption("coalesce-latency", "Maximum time in milliseconds that samples are held back by --coalesce", value<unsigned int>()->default_value(to_string(dataSourceConfig.coalesceLatency.count())));
+  addOption("hugepages", "Allocate the sample buffers on huge pages (reserved ones if available, transparent ones otherwise)", value<bool>());
+  addOption("j,threads", "Number of decoding threads for --headless with --input-file (0: one per CPU core). Frames are decoded in parallel.", value<unsigned int>()->default_value(to_string(visualizerConfig.decodeThreads)));
+  addOption("convert", "Write samples of the input file or device to a native capture file (for instant, zero-copy replay via --input-file) instead of visualizing them", value<std::string>());
+  addOption("record", "Write the samples captured from the device to a native capture file while visualizing them. Packets are dropped from the recording when the disk is too slow.", value<std::string>());
+  addOption("serve", "Publish the frames to viewers (--connect) instead of showing them in a window, e.g. for headless hosts. Address is a TCP port, optionally with host (default 127.0.0.1, e.g. 5900 or 0.0.0.0:5900), or a Unix domain socket path containing a slash (e.g. ./vidgrok.sock).", value<std::string>());
+  addOption("connect", "Show the frames published by another vidgrok instance (--serve) at the given address", value<std::string>());
+  addOption("stats", "Collect statistics of the processing pipeline (toggle the overlay with S)", value<bool>());
+  addOption("stats-file", "Periodically write statistics as JSON lines to a file (- for stderr). Implies --stats.", value<std::string>());
+  addOption("stats-interval", "Interval of --stats-file in milliseconds", value<unsigned int>()->default_value(to_string(statisticsInterval.count())));
+  addOption("seekable", "Play the (single) --input-file with random access: space pauses, left/right steps a frame, page up/down skips 50 frames, home restarts, +/- changes the speed, U plays as fast as possible. Frames are indexed in <file>.vgi.", value<bool>());
+  addOption("zoom", "Inspect the (single) --input-file in a zoomable view instead of playing it: left/right pans, up/down scrolls, +/- zooms the samples, [/] the lines, page up/down changes the frame, M shows the channels set in all instead of any samples of a pixel, home shows the whole line.", value<bool>());
+  addOption("start-frame", "Frame to start --seekable playback or --zoom at", value<size_t>()->default_value("0"));
   addOption("k,keep-going", "Try to continue capturing even after device driver's session has ended. Will loop forever in combination with recorded sessions (--input-file).", value<bool>());
+  addOption("format", "Output format of the analyze subcommand (vidgrok analyze [options]): csv or json (one object per frame). Written to --output, stdout by default.", value<std::string>()->default_value("csv"));
   addOption("h,help", "Print usage");
 
   auto result = options.parse(argc, argv);
@@ -79,13 +411,15 @@ auto App::processOptions(int argc, char** argv) -> bool {
     visualizerConfig.dataRedChannel = stoi(dataChannels.substr(0, 1));
     visualizerConfig.dataGreenChannel = visualizerConfig.dataRedChannel;
     visualizerConfig.dataBlueChannel = visualizerConfig.dataRedChannel;
+  } else if (dataChannels.find(',') != std::string::npos) {
+    parseColorChannels(dataChannels);
   } else if (dataChannels.size() == 3) {
     // individual 3-bit colors
     visualizerConfig.dataRedChannel = stoi(dataChannels.substr(0, 1));
     visualizerConfig.dataGreenChannel = stoi(dataChannels.substr(1, 1));
     visualizerConfig.dataBlueChannel = stoi(dataChannels.substr(2, 1));
   } else {
-    throw std::runtime_error("Argument --data can only be a single digit (e.g. --data 2) or three digits (e.g. --data 234)");
+    throw std::runtime_error("Argument --data can only be a single digit (e.g. --data 2), three digits (e.g. --data 234) or three comma separated channels or ranges (e.g. --data 11-8,7-4,3-0)");
   }
 
   visualizerConfig.width = result["width"].as<int>();
@@ -97,12 +431,32 @@ auto App::processOptions(int argc, char** argv) -> bool {
   visualizerConfig.invertHSync = result["invert-hsync"].as<bool>();
   visualizerConfig.disableVSync = result["no-vsync"].as<bool>();
   visualizerConfig.disableHSync = result["no-hsync"].as<bool>();
+  visualizerConfig.compositeSync = result["csync"].as<bool>();
   visualizerConfig.highlightVSync = result["highlight-vsync"].as<bool>();
   visualizerConfig.highlightHSync = result["highlight-hsync"].as<bool>();
   visualizerConfig.renderHiddenData = result["hidden-data"].as<bool>();
+  visualizerConfig.decimation = result["decimate"].as<unsigned int>();
+  visualizerConfig.boxFilter = result["box-filter"].as<bool>();
+  visualizerConfig.linePixels = result["line-pixels"].as<unsigned int>();
+  visualizerConfig.cropLeft = result["crop-left"].as<long int>();
+  visualizerConfig.cropTop = result["crop-top"].as<long int>();
   visualizerConfig.renderSynced = result["render-synced"].as<bool>();
+  if (result.count("persistence")) {
+    visualizerConfig.persistence = parsePersistence(result["persistence"].as<std::string>());
+  }
+  visualizerConfig.persistenceFrames = result["persistence-frames"].as<unsigned int>();
+  visualizerConfig.syncLock = result["sync-lock"].as<bool>();
+  visualizerConfig.autoMode = result["auto-mode"].as<bool>();
+  visualizerConfig.headless = result["headless"].as<bool>();
+  outputPaths = result.count("output") ? result["output"].as<std::vector<std::string>>() : std::vector<std::string>();
+  visualizerConfig.outputPath = outputPaths.empty() ? std::string() : outputPaths.front();
+  visualizerConfig.skipUnchangedFrames = result["skip-unchanged"].as<bool>();
+  visualizerConfig.decodeThreads = result["threads"].as<unsigned int>();
+  if (visualizerConfig.decodeThreads == 0) {
+    visualizerConfig.decodeThreads = std::max(1U, std::thread::hardware_concurrency());
+  }
 
-  auto maxChannels = sizeof(Sample) * 8 - 1;
+  auto maxChannels = sizeof(WideSample) * 8 - 1;
   if (visualizerConfig.dataRedChannel > maxChannels || visualizerConfig.dataGreenChannel > maxChannels || visualizerConfig.dataBlueChannel > maxChannels) {
     throw std::runtime_error(std::string("Maximum channel number (digit) to pass via --data is ") + std::to_string(maxChannels));
   }
@@ -118,18 +472,63 @@ auto App::processOptions(int argc, char** argv) -> bool {
   if (visualizerConfig.height < 1) {
     throw std::runtime_error("Window height must be greater than 0");
   }
+  if (visualizerConfig.decimation < 1) {
+    throw std::runtime_error("Decimation (--decimate) must be greater than 0");
+  }
+  if (visualizerConfig.linePixels > 0 && visualizerConfig.decimation > 1) {
+    throw std::runtime_error("Resampling (--line-pixels) can not be combined with --decimate");
+  }
+  if (visualizerConfig.linePixels > 0 && visualizerConfig.disableHSync) {
+    throw std::runtime_error("Resampling (--line-pixels) needs the horizontal sync");
+  }
+  if (visualizerConfig.cropLeft < 0 || visualizerConfig.cropTop < 0) {
+    throw std::runtime_error("Crop window (--crop-left, --crop-top) can not start before the sync edges");
+  }
 
   dataSourceConfig.sampleRate = result["sample-rate"].as<uint64_t>();
   dataSourceConfig.driverName = result.count("driver") ? std::optional<std::string>(result["driver"].as<std::string>()) : std::optional<std::string>();
-  dataSourceConfig.inputFile = result.count("input-file") ? std::optional<std::string>(result["input-file"].as<std::string>()) : std::optional<std::string>();
+  const auto inputFiles = result.count("input-file") ? result["input-file"].as<std::vector<std::string>>() : std::vector<std::string>();
+  const auto deviceIndices = result.count("device") ? result["device"].as<std::vector<unsigned int>>() : std::vector<unsigned int>();
+  dataSourceConfig.inputFile = inputFiles.empty() ? std::optional<std::string>() : std::optional<std::string>(inputFiles.front());
   dataSourceConfig.keepGoing = result["keep-going"].as<bool>();
-  dataSourceConfig.enabledChannels = std::set<uint8_t>({
-    visualizerConfig.dataRedChannel,
-    visualizerConfig.dataGreenChannel,
-    visualizerConfig.dataBlueChannel,
-    visualizerConfig.vSyncChannel,
-    visualizerConfig.hSyncChannel,
-  });
+  dataSourceConfig.coalesceBytes = result["coalesce"].as<size_t>();
+  dataSourceConfig.coalesceLatency = std::chrono::milliseconds(result["coalesce-latency"].as<unsigned int>());
+  dataSourceConfig.hugePages = result["hugepages"].as<bool>();
+  convertPath = result.count("convert") ? std::optional<std::string>(result["convert"].as<std::string>()) : std::optional<std::string>();
+  recordPath = result.count("record") ? std::optional<std::string>(result["record"].as<std::string>()) : std::optional<std::string>();
+  statisticsPath = result.count("stats-file") ? std::optional<std::string>(result["stats-file"].as<std::string>()) : std::optional<std::string>();
+  statisticsEnabled = result["stats"].as<bool>() || statisticsPath;
+  statisticsInterval = std::chrono::milliseconds(result["stats-interval"].as<unsigned int>());
+  seekable = result["seekable"].as<bool>();
+  zoom = result["zoom"].as<bool>();
+  serveAddress = result.count("serve") ? std::optional<std::string>(result["serve"].as<std::string>()) : std::optional<std::string>();
+  connectAddress = result.count("connect") ? std::optional<std::string>(result["connect"].as<std::string>()) : std::optional<std::string>();
+  startFrame = result["start-frame"].as<size_t>();
+  analysisFormat = parseAnalysisFormat(result["format"].as<std::string>());
+  dataSourceConfig.enabledChannels = std::set<uint8_t>({visualizerConfig.hSyncChannel});
+  if (!visualizerConfig.compositeSync) {
+    dataSourceConfig.enabledChannels.insert(visualizerConfig.vSyncChannel);
+  }
+  for (uint8_t bit = 0; bit < visualizerConfig.colorDepth; bit++) {
+    dataSourceConfig.enabledChannels.insert(static_cast<uint8_t>(visualizerConfig.dataRedChannel - bit));
+    dataSourceConfig.enabledChannels.insert(static_cast<uint8_t>(visualizerConfig.dataGreenChannel - bit));
+    dataSourceConfig.enabledChannels.insert(static_cast<uint8_t>(visualizerConfig.dataBlueChannel - bit));
+  }
+  wideSamples = *dataSourceConfig.enabledChannels.rbegin() >= sizeof(Sample) * 8;
+
+  // One stream per input file or device (the first device by default)
+  dataSourceConfigs.clear();
+  for (const auto& inputFile : inputFiles) {
+    dataSourceConfigs.push_back(dataSourceConfig);
+    dataSourceConfigs.back().inputFile = inputFile;
+  }
+  for (const auto deviceIndex : deviceIndices) {
+    dataSourceConfigs.push_back(dataSourceConfig);
+    dataSourceConfigs.back().deviceIndex = deviceIndex;
+  }
+  if (dataSourceConfigs.empty()) {
+    dataSourceConfigs.push_back(dataSourceConfig);
+  }
 
   // Check some contradicting settings
 
@@ -137,9 +536,190 @@ auto App::processOptions(int argc, char** argv) -> bool {
     throw std::runtime_error("Can not use a driver and an input file at the same time.");
   }
 
+  if (!deviceIndices.empty() && !inputFiles.empty()) {
+    throw std::runtime_error("Can not use devices (--device) and input files at the same time.");
+  }
+
+  if (dataSourceConfigs.size() > 1 && (convertPath || recordPath || statisticsEnabled || visualizerConfig.decodeThreads > 1)) {
+    throw std::runtime_error("Converting, recording, statistics and parallel decoding (--threads) are only available for a single stream.");
+  }
+
+  if (analyze && (dataSourceConfigs.size() > 1 || outputPaths.size() > 1 || visualizerConfig.headless || seekable || zoom || serveAddress || connectAddress || convertPath || recordPath || visualizerConfig.autoMode)) {
+    throw std::runtime_error("The analyze subcommand takes a single stream and output, and no other mode (--headless, --seekable, --zoom, --serve, --connect, --convert, --record, --auto-mode).");
+  }
+
+  if (analyze && visualizerConfig.disableVSync) {
+    throw std::runtime_error("The analyze subcommand measures per frame and requires vertical sync.");
+  }
+
+  if (visualizerConfig.headless && outputPaths.size() != dataSourceConfigs.size()) {
+    throw std::runtime_error("Headless mode requires one output (--output) per stream.");
+  }
+
   if (visualizerConfig.disableVSync && visualizerConfig.renderSynced) {
     throw std::runtime_error("Can not render synchronously when vertical sync is disabled.");
   }
 
+  if ((visualizerConfig.cropLeft > 0 || visualizerConfig.cropTop > 0) && (visualizerConfig.disableHSync || visualizerConfig.disableVSync)) {
+    throw std::runtime_error("Cropping (--crop-left, --crop-top) is relative to the sync edges and requires horizontal and vertical sync.");
+  }
+
+  if (convertPath && dataSourceConfig.inputFile && dataSourceConfig.keepGoing) {
+    throw std::runtime_error("Can not convert a looping input file (--keep-going).");
+  }
+
+  if (recordPath && (dataSourceConfig.inputFile || convertPath)) {
+    throw std::runtime_error("Recording (--record) is only available for live captures from a device. Use --convert for input files.");
+  }
+
+  if (visualizerConfig.skipUnchangedFrames && !visualizerConfig.headless) {
+    throw std::runtime_error("Skipping unchanged frames (--skip-unchanged) is only available for --headless. The window skips them anyway.");
+  }
+
+  if (visualizerConfig.decodeThreads > 1 && (!visualizerConfig.headless || !dataSourceConfig.inputFile || dataSourceConfig.keepGoing || convertPath)) {
+    throw std::runtime_error("Parallel decoding (--threads) is only available for --headless with a single pass over an --input-file.");
+  }
+
+  if (visualizerConfig.syncLock && visualizerConfig.disableHSync) {
+    throw std::runtime_error("Sync lock (--sync-lock) requires horizontal sync.");
+  }
+
+  if (visualizerConfig.syncLock && visualizerConfig.decodeThreads > 1) {
+    throw std::runtime_error("Sync lock (--sync-lock) needs the complete signal history and can not be combined with parallel decoding (--threads).");
+  }
+
+  // Every segment would start with an unknown line period and leave its first lines empty
+  if (visualizerConfig.linePixels > 0 && visualizerConfig.decodeThreads > 1) {
+    throw std::runtime_error("Resampling (--line-pixels) learns the line period from the complete signal history and can not be combined with parallel decoding (--threads).");
+  }
+
+  if (visualizerConfig.compositeSync && (visualizerConfig.disableHSync || visualizerConfig.disableVSync)) {
+    throw std::runtime_error("Composite sync (--csync) can not be combined with disabled synchronisation (--no-hsync, --no-vsync).");
+  }
+
+  if (visualizerConfig.compositeSync && (visualizerConfig.highlightVSync || visualizerConfig.autoMode || visualizerConfig.decodeThreads > 1)) {
+    throw std::runtime_error("Composite sync (--csync) is not available with --highlight-vsync, --auto-mode or parallel decoding (--threads), which need a vertical sync channel.");
+  }
+
+  if (visualizerConfig.autoMode && (visualizerConfig.disableHSync || visualizerConfig.disableVSync)) {
+    throw std::runtime_error("Video mode detection (--auto-mode) requires horizontal and vertical sync.");
+  }
+
+  if (visualizerConfig.autoMode && (dataSourceConfigs.size() > 1 || convertPath)) {
+    throw std::runtime_error("Video mode detection (--auto-mode) is only available for visualizing a single stream.");
+  }
+
+  if (visualizerConfig.persistence != Persistence::Off && visualizerConfig.disableVSync) {
+    throw std::runtime_error("Persistence (--persistence) blends complete frames and requires vertical sync.");
+  }
+
+  if (visualizerConfig.persistence != Persistence::Off && visualizerConfig.decodeThreads > 1) {
+    throw std::runtime_error("Persistence (--persistence) needs the frames in order and can not be combined with parallel decoding (--threads).");
+  }
+
+  if (visualizerConfig.persistenceFrames < 2 || visualizerConfig.persistenceFrames > FrameAccumulator::MAX_FRAMES) {
+    throw std::runtime_error("Number of persistence frames (--persistence-frames) must be between 2 and " + std::to_string(FrameAccumulator::MAX_FRAMES) + ".");
+  }
+
+  if (statisticsInterval.count() == 0) {
+    throw std::runtime_error("Statistics interval (--stats-interval) must be greater than 0.");
+  }
+
+  if (statisticsEnabled && visualizerConfig.decodeThreads > 1) {
+    throw std::runtime_error("Statistics (--stats) are not available for parallel decoding (--threads).");
+  }
+
+  if (seekable && (dataSourceConfigs.size() != 1 || !dataSourceConfig.inputFile)) {
+    throw std::runtime_error("Seekable playback (--seekable) requires a single --input-file.");
+  }
+
+  if (seekable && (visualizerConfig.headless || convertPath || statisticsEnabled || visualizerConfig.autoMode || visualizerConfig.decodeThreads > 1)) {
+    throw std::runtime_error("Seekable playback (--seekable) is only available in the window and can not be combined with --convert, --stats, --auto-mode or parallel decoding (--threads).");
+  }
+
+  if (seekable && (visualizerConfig.disableVSync || visualizerConfig.compositeSync)) {
+    throw std::runtime_error("Seekable playback (--seekable) indexes the frames by the vertical sync channel and requires it (not --no-vsync or --csync).");
+  }
+
+  if (zoom && (dataSourceConfigs.size() != 1 || !dataSourceConfig.inputFile)) {
+    throw std::runtime_error("Zooming (--zoom) requires a single --input-file.");
+  }
+
+  if (zoom && (seekable || visualizerConfig.headless || convertPath || statisticsEnabled || visualizerConfig.autoMode || visualizerConfig.decodeThreads > 1 || visualizerConfig.linePixels > 0)) {
+    throw std::runtime_error("Zooming (--zoom) is only available in the window and can not be combined with --seekable, --convert, --stats, --auto-mode, parallel decoding (--threads) or --line-pixels.");
+  }
+
+  if (zoom && (visualizerConfig.disableVSync || visualizerConfig.compositeSync)) {
+    throw std::runtime_error("Zooming (--zoom) indexes the frames by the vertical sync channel and requires it (not --no-vsync or --csync).");
+  }
+
+  if (connectAddress && (!inputFiles.empty() || !deviceIndices.empty() || dataSourceConfig.driverName || serveAddress || visualizerConfig.headless || convertPath || recordPath || seekable || zoom)) {
+    throw std::runtime_error("A viewer (--connect) only shows the frames of the server, capture options can not be used.");
+  }
+
+  if (serveAddress && (dataSourceConfigs.size() > 1 || visualizerConfig.headless || convertPath || seekable || zoom || visualizerConfig.autoMode)) {
+    throw std::runtime_error("Serving frames (--serve) is only available for a single stream instead of the window and can not be combined with --headless, --convert, --seekable, --zoom or --auto-mode.");
+  }
+
+  if (startFrame > 0 && !seekable && !zoom) {
+    throw std::runtime_error("A start frame (--start-frame) requires --seekable or --zoom.");
+  }
+
+  if (visualizerConfig.headless && visualizerConfig.disableVSync) {
+    throw std::runtime_error("Headless mode needs vertical sync to detect complete frames.");
+  }
+
   return true;
 }
+
+auto App::parsePersistence(const std::string& persistence) -> Persistence {
+  if (persistence == "decay") {
+    return Persistence::Decay;
+  }
+  if (persistence == "average") {
+    return Persistence::Average;
+  }
+  if (persistence == "max") {
+    return Persistence::MaxHold;
+  }
+  throw std::runtime_error("Argument --persistence must be decay, average or max.");
+}
+
+auto App::parseAnalysisFormat(const std::string& format) -> AnalysisFormat {
+  if (format == "csv") {
+    return AnalysisFormat::Csv;
+  }
+  if (format == "json") {
+    return AnalysisFormat::Json;
+  }
+  throw std::runtime_error("Argument --format must be csv or json.");
+}
+
+// Parse "red,green,blue" where each color is a channel or a range of channels (most significant first)
+auto App::parseColorChannels(const std::string& dataChannels) -> void {
+  std::vector<std::pair<int, int>> ranges;
+  std::stringstream stream(dataChannels);
+  std::string color;
+  while (std::getline(stream, color, ',')) {
+    const auto separator = color.find('-');
+    const int first = stoi(color.substr(0, separator));
+    const int last = separator == std::string::npos ? first : stoi(color.substr(separator + 1));
+    ranges.emplace_back(first, last);
+  }
+  if (ranges.size() != 3) {
+    throw std::runtime_error("Argument --data needs exactly three comma separated colors (red, green and blue).");
+  }
+  for (const auto& [first, last] : ranges) {
+    if (first < last || first - last != ranges[0].first - ranges[0].second || last < 0) {
+      throw std::runtime_error("Color channel ranges passed via --data must have the same length and start with the most significant channel (e.g. --data 11-8,7-4,3-0).");
+    }
+  }
+  if (ranges[0].first - ranges[0].second + 1 > MAX_COLOR_DEPTH) {
+    throw std::runtime_error("Maximum number of channels per color is " + std::to_string(MAX_COLOR_DEPTH));
+  }
+
+  visualizerConfig.dataRedChannel = static_cast<uint8_t>(ranges[0].first);
+  visualizerConfig.dataGreenChannel = static_cast<uint8_t>(ranges[1].first);
+  visualizerConfig.dataBlueChannel = static_cast<uint8_t>(ranges[2].first);
+  visualizerConfig.colorDepth = static_cast<uint8_t>(ranges[0].first - ranges[0].second + 1);
+}
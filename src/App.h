@@ -2,13 +2,71 @@
 
 #include "DataSource.h"
 #include "DataVisualizer.h"
+#include "SignalAnalyzer.h"
+#include "VideoModeDetector.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Everything that belongs to one captured stream (device or input file)
+template <typename T>
+struct Stream {
+  VisualizerConfiguration visualizerConfig; // with the stream's sample rate and output
+  std::unique_ptr<DataDispatcher<T>> dataDispatcher;
+  std::unique_ptr<DataSource<T>> dataSource;
+  std::thread dataSourceThread;
+};
+
 class App final {
 public:
   auto run(int argc, char** argv) -> int;
 
 private:
   auto processOptions(int argc, char** argv) -> bool;
+  auto parseColorChannels(const std::string& dataChannels) -> void;
+  [[nodiscard]] static auto parsePersistence(const std::string& persistence) -> Persistence;
+  [[nodiscard]] static auto parseAnalysisFormat(const std::string& format) -> AnalysisFormat;
+  // Capture, decode and output with samples of type T (Sample or WideSample)
+  template <typename T>
+  auto runPipeline() -> void;
+  // Seekable playback of a recorded session in the window
+  template <typename T>
+  auto playCapture() -> void;
+  // Zoomable view of a recorded session in the window
+  template <typename T>
+  auto zoomCapture() -> void;
+  // vidgrok analyze: signal metrics per frame
+  template <typename T>
+  auto analyzeStream() -> void;
+  template <typename T>
+  auto exportStreams(std::vector<Stream<T>>& streams) -> void;
+  // Analyze the first frames of the (single) stream and configure sync polarities, crop window and size from them
+  template <typename T>
+  auto detectVideoMode() -> void;
+  auto applyVideoMode(const VideoMode& videoMode) -> void;
 
   VisualizerConfiguration visualizerConfig;
-  DataSourceConfiguration dataSourceConfig;
+  DataSourceConfiguration dataSourceConfig;               // common settings of all streams
+  std::vector<DataSourceConfiguration> dataSourceConfigs; // one per stream
+  std::vector<std::string> outputPaths;                   // headless mode: one per stream
+  std::optional<std::string> convertPath;
+  std::optional<std::string> recordPath; // tee of live capture
+  bool wideSamples = false; // channels above 7 are used
+  bool statisticsEnabled = false;
+  std::optional<std::string> statisticsPath; // JSON lines output
+  std::chrono::milliseconds statisticsInterval = std::chrono::milliseconds(1000);
+  bool seekable = false;
+  bool zoom = false;
+  std::optional<std::string> serveAddress;   // frames are published to viewers instead of the window
+  std::optional<std::string> connectAddress; // viewer of another instance
+  size_t startFrame = 0;
+  bool analyze = false; // subcommand
+  AnalysisFormat analysisFormat = AnalysisFormat::Csv;
+
+  static constexpr uint64_t MAX_DETECTION_SECONDS = 2; // of samples analyzed before giving up
+  static constexpr int MAX_COLOR_DEPTH = 4; // 12 data and 2 sync channels of a 16 channel device
 };
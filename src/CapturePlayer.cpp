@@ -0,0 +1,180 @@
+#include "CapturePlayer.h"
+#include <algorithm>
+#include <sstream>
+
+template <typename T>
+CapturePlayer<T>::CapturePlayer(
+  std::span<T> samples,
+  const FrameIndex<T>& frameIndex,
+  uint64_t sampleRate,
+  bool loop
+) : mSamples(samples),
+    mFrameIndex(frameIndex),
+    mLoop(loop),
+    clock(sampleRate) {
+}
+
+template <typename T>
+auto CapturePlayer<T>::togglePause() -> void {
+  std::lock_guard lock(mutex);
+  if (paused) {
+    paused = false;
+    stepping = false;
+    clock.reset(position); // continue in real time from here instead of catching up
+  } else {
+    paused = true;
+  }
+  notifyDecoder();
+}
+
+// Stepping to the next frame just finishes it, everything else restarts decoding at the frame.
+template <typename T>
+auto CapturePlayer<T>::step(long int frames) -> void {
+  std::lock_guard lock(mutex);
+  paused = true;
+  if (frames == 1 && !pendingSeek) {
+    stepping = true;
+  } else if (frames < 0 && static_cast<size_t>(-frames) > shownFrame) {
+    seekLocked(0, true);
+  } else {
+    seekLocked(shownFrame + static_cast<size_t>(frames), true);
+  }
+  notifyDecoder();
+}
+
+template <typename T>
+auto CapturePlayer<T>::seek(size_t frame) -> void {
+  std::lock_guard lock(mutex);
+  seekLocked(frame, paused);
+  notifyDecoder();
+}
+
+template <typename T>
+auto CapturePlayer<T>::skip(long int frames) -> void {
+  std::lock_guard lock(mutex);
+  const auto frame = frames < 0 && static_cast<size_t>(-frames) > shownFrame ? 0 : shownFrame + static_cast<size_t>(frames);
+  seekLocked(frame, paused);
+  notifyDecoder();
+}
+
+template <typename T>
+auto CapturePlayer<T>::changeSpeed(double factor) -> void {
+  clock.setSpeed(clock.getSpeed() * factor);
+}
+
+template <typename T>
+auto CapturePlayer<T>::toggleUnthrottled() -> void {
+  clock.setUnthrottled(!clock.isUnthrottled());
+}
+
+template <typename T>
+auto CapturePlayer<T>::interrupt() -> void {
+  std::lock_guard lock(mutex);
+  notifyDecoder();
+}
+
+template <typename T>
+auto CapturePlayer<T>::getStatus() const -> std::string {
+  std::lock_guard lock(mutex); // the decoder thread updates shownFrame
+  const auto frameCount = mFrameIndex.getFrameCount();
+  std::ostringstream status;
+  status << "FRAME " << shownFrame << "/" << frameCount << (mFrameIndex.isComplete() ? "" : " INDEXING");
+  if (clock.isUnthrottled()) {
+    status << " UNTHROTTLED";
+  } else {
+    status << " " << clock.getSpeed() << "X";
+  }
+  if (paused) {
+    status << " PAUSED";
+  }
+
+  return status.str();
+}
+
+template <typename T>
+auto CapturePlayer<T>::nextBlock() -> Block {
+  std::unique_lock lock(mutex);
+  Block block;
+  if (pendingSeek) {
+    const auto frameCount = mFrameIndex.getFrameCount();
+    if (pendingSeek.value() < frameCount || (mFrameIndex.isComplete() && frameCount > 0)) {
+      position = mFrameIndex.getFrameStart(std::min(pendingSeek.value(), frameCount - 1)).value();
+      pendingSeek.reset();
+      restartPosition = position;
+      clock.reset(position);
+      block.restart = true;
+      block.position = position;
+      block.previousSample = position > 0 ? mSamples[position - 1] : 0;
+    } else if (mFrameIndex.isComplete()) {
+      pendingSeek.reset(); // capture without frames
+    }
+  }
+
+  if ((paused && !stepping) || pendingSeek) {
+    commandGiven.wait_for(lock, PAUSE_POLL_INTERVAL); // pendingSeek: frame not indexed yet
+    return block;
+  }
+
+  if (position >= mSamples.size()) {
+    if (!mLoop) {
+      paused = true;
+      stepping = false;
+      return block;
+    }
+    position = 0;
+    restartPosition = position;
+    clock.reset(position);
+    block.restart = true;
+    block.position = position;
+  }
+
+  block.samples = mSamples.subspan(position, std::min(BLOCK_SIZE, mSamples.size() - position));
+  block.position = position;
+  position += block.samples.size();
+
+  return block;
+}
+
+template <typename T>
+auto CapturePlayer<T>::pace(uint64_t streamPosition) -> void {
+  {
+    std::lock_guard lock(mutex);
+    if (stepping) {
+      return;
+    }
+  }
+  clock.waitUntil(streamPosition);
+}
+
+template <typename T>
+auto CapturePlayer<T>::frameCompleted(uint64_t streamPosition) -> bool {
+  std::lock_guard lock(mutex);
+  if (restartPosition == streamPosition) {
+    return false; // start of the frame decoding restarted at, the previous one hasn't been decoded
+  }
+  restartPosition.reset();
+  const auto frame = mFrameIndex.findFrame(streamPosition);
+  shownFrame = frame > 0 ? frame - 1 : 0;
+  if (stepping) {
+    stepping = false;
+    paused = true;
+  }
+
+  return true;
+}
+
+template <typename T>
+auto CapturePlayer<T>::seekLocked(size_t frame, bool stepToFrame) -> void {
+  pendingSeek = frame;
+  stepping = stepToFrame;
+}
+
+// Mutex held. The decoder might be waiting for a command or for the clock.
+template <typename T>
+auto CapturePlayer<T>::notifyDecoder() -> void {
+  commandGiven.notify_all();
+  clock.interrupt();
+}
+
+template class CapturePlayer<Sample>;
+template class CapturePlayer<WideSample>;
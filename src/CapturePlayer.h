@@ -0,0 +1,80 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "FrameIndex.h"
+#include "PlaybackClock.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+
+// Random access playback of a recorded capture: pause, single-step, seek to frames and play at any speed or
+// unthrottled. The presenter gives the commands, the decoder thread fetches the blocks to decode (see StreamDecoder).
+// Frames are numbered by the frame index; a frame is complete when the next one starts.
+template <typename T>
+class CapturePlayer final {
+public:
+  // Block of samples to decode next
+  struct Block {
+    std::span<T> samples;  // empty while paused
+    uint64_t position = 0; // stream offset of the first sample
+    bool restart = false;  // the decoder has to start over here (previousSample is the sample right before)
+    T previousSample = 0;
+  };
+
+  CapturePlayer(
+    std::span<T> samples,
+    const FrameIndex<T>& frameIndex,
+    uint64_t sampleRate,
+    bool loop
+  );
+
+  // To be called by presenter:
+  auto togglePause() -> void;
+  // Pause and show the frame relative to the currently shown one
+  auto step(long int frames) -> void;
+  // Continue at the given frame (delayed until the frame index reaches it)
+  auto seek(size_t frame) -> void;
+  // Jump relative to the currently shown frame
+  auto skip(long int frames) -> void;
+  auto changeSpeed(double factor) -> void;
+  auto toggleUnthrottled() -> void;
+  // Wake up the decoder (e.g. to stop it)
+  auto interrupt() -> void;
+  // e.g. "FRAME 12/345 2X PAUSED" (overlay font compatible)
+  [[nodiscard]] auto getStatus() const -> std::string;
+
+  // To be called by decoder:
+  // Next block to decode. Waits a moment and returns an empty block while paused.
+  auto nextBlock() -> Block;
+  // Wait until the position is due (not while stepping)
+  auto pace(uint64_t position) -> void;
+  // A frame has been completed at the given position. Returns false if it should not be shown (the frame has only
+  // partially been decoded after a restart).
+  auto frameCompleted(uint64_t position) -> bool;
+
+private:
+  auto seekLocked(size_t frame, bool stepToFrame) -> void;
+  auto notifyDecoder() -> void;
+
+  const std::span<T> mSamples;
+  const FrameIndex<T>& mFrameIndex;
+  const bool mLoop;
+  PlaybackClock clock;
+
+  mutable std::mutex mutex;
+  std::condition_variable commandGiven;
+  uint64_t position = 0;                   // next sample to decode
+  std::optional<uint64_t> restartPosition; // of the last restart, until a frame has been completed
+  std::optional<size_t> pendingSeek;       // frame
+  bool paused = false;
+  bool stepping = false; // decode until the next frame is complete, then pause
+  size_t shownFrame = 0;
+
+  static constexpr size_t BLOCK_SIZE = 64 * 1024; // similar to libsigrok packets, keeps commands responsive
+  static constexpr std::chrono::milliseconds PAUSE_POLL_INTERVAL = std::chrono::milliseconds(50);
+};
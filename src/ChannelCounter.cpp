@@ -0,0 +1,70 @@
+#include "ChannelCounter.h"
+#include <bit>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+template <typename T>
+auto ChannelCounter<T>::count(std::span<const T> samples) -> void {
+  if (samples.empty()) {
+    return;
+  }
+  countScalar(samples[0], hasPreviousSample ? previousSample : samples[0]);
+  hasPreviousSample = true;
+  previousSample = samples.back();
+
+  const size_t size = samples.size();
+  size_t i = 1; // samples[i] is compared to samples[i - 1]
+
+#ifdef __SSE2__
+  // Shifting left by 7 - bit moves that bit of every byte into its most significant bit, which movemask gathers for
+  // 16 bytes at once. The bits of the edges are the same for the samples XORed with their predecessors.
+  // Wide samples have the channels 0-7 in the even and the channels 8-15 in the odd bytes.
+  constexpr size_t lanes = 16 / sizeof(T);
+  __m128i shifts[8];
+  for (int bit = 0; bit < 8; bit++) {
+    shifts[bit] = _mm_cvtsi32_si128(7 - bit);
+  }
+  for (; i + lanes <= size; i += lanes) {
+    const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+    const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i - 1]));
+    const __m128i edges = _mm_xor_si128(current, previous);
+    for (size_t bit = 0; bit < 8; bit++) {
+      const auto high = static_cast<uint32_t>(_mm_movemask_epi8(_mm_sll_epi64(current, shifts[bit])));
+      const auto edge = static_cast<uint32_t>(_mm_movemask_epi8(_mm_sll_epi64(edges, shifts[bit])));
+      if constexpr (sizeof(T) == 1) {
+        highCounts[bit] += static_cast<uint64_t>(std::popcount(high));
+        edgeCounts[bit] += static_cast<uint64_t>(std::popcount(edge));
+      } else {
+        highCounts[bit] += static_cast<uint64_t>(std::popcount(high & 0x5555U));
+        highCounts[bit + 8] += static_cast<uint64_t>(std::popcount(high & 0xaaaaU));
+        edgeCounts[bit] += static_cast<uint64_t>(std::popcount(edge & 0x5555U));
+        edgeCounts[bit + 8] += static_cast<uint64_t>(std::popcount(edge & 0xaaaaU));
+      }
+    }
+  }
+#endif
+
+  for (; i < size; i++) {
+    countScalar(samples[i], samples[i - 1]);
+  }
+}
+
+template <typename T>
+auto ChannelCounter<T>::reset() -> void {
+  highCounts = {};
+  edgeCounts = {};
+}
+
+template <typename T>
+auto ChannelCounter<T>::countScalar(T sample, T previous) -> void {
+  const T edges = static_cast<T>(sample ^ previous);
+  for (size_t channel = 0; channel < CHANNEL_COUNT; channel++) {
+    highCounts[channel] += (sample >> channel) & 1U;
+    edgeCounts[channel] += (edges >> channel) & 1U;
+  }
+}
+
+template class ChannelCounter<Sample>;
+template class ChannelCounter<WideSample>;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Counts the high samples and the edges of every channel. Blocks may be split anywhere: the edge between the last
+// sample of a block and the first one of the next block is counted, too.
+// T is the sample type (Sample or WideSample).
+template <typename T>
+class ChannelCounter final {
+public:
+  static constexpr size_t CHANNEL_COUNT = sizeof(T) * 8;
+
+  auto count(std::span<const T> samples) -> void;
+  // Clear the counts (the last sample is kept for the next edge)
+  auto reset() -> void;
+  // The next block doesn't follow the last one (samples were dropped in between), so no edge is counted between them
+  auto skipGap() -> void {
+    hasPreviousSample = false;
+  }
+
+  [[nodiscard]] auto getHighCount(size_t channel) const -> uint64_t {
+    return highCounts[channel];
+  }
+  [[nodiscard]] auto getEdgeCount(size_t channel) const -> uint64_t {
+    return edgeCounts[channel];
+  }
+
+private:
+  inline auto countScalar(T sample, T previous) -> void;
+
+  std::array<uint64_t, CHANNEL_COUNT> highCounts = {};
+  std::array<uint64_t, CHANNEL_COUNT> edgeCounts = {};
+  T previousSample = 0;
+  bool hasPreviousSample = false;
+};
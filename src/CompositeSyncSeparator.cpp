@@ -0,0 +1,53 @@
+#include "CompositeSyncSeparator.h"
+#include <cmath>
+
+auto CompositeSyncSeparator::separate(bool syncActive, uint64_t length) -> SeparatedSync {
+  // Runs of the same level may follow each other (split at block boundaries), only level changes count.
+  if (syncActive && !inPulse) {
+    startPulse();
+  } else if (!syncActive && inPulse) {
+    endPulse();
+  }
+  inPulse = syncActive;
+  if (inPulse) {
+    pulseLength += length;
+  }
+  position += length;
+
+  return SeparatedSync{inPulse && lineSyncPulse, vSyncActive};
+}
+
+auto CompositeSyncSeparator::getLineLength() const -> double {
+  return linePeriod;
+}
+
+// Decided on the leading edge, so the whole pulse gets the same horizontal sync level
+auto CompositeSyncSeparator::startPulse() -> void {
+  pulseLength = 0;
+  const auto interval = static_cast<double>(position - lastLineSyncStart);
+  lineSyncPulse = !hasLineSync || linePeriod == 0 || interval >= HALF_LINE_LIMIT * linePeriod;
+  if (!lineSyncPulse) {
+    return; // equalizing pulse or serration in the middle of a line
+  }
+  if (hasLineSync) {
+    learnLinePeriod(interval);
+  }
+  hasLineSync = true;
+  lastLineSyncStart = position;
+}
+
+auto CompositeSyncSeparator::endPulse() -> void {
+  const bool broad = linePeriod > 0 && static_cast<double>(pulseLength) > BROAD_PULSE * linePeriod;
+  vSyncActive = broad;
+}
+
+// Half lines at the start (equalizing pulses) or missing pulses don't disturb a learned period for long.
+auto CompositeSyncSeparator::learnLinePeriod(double interval) -> void {
+  if (linePeriod > 0 && std::abs(interval - linePeriod) <= TOLERANCE * linePeriod) {
+    linePeriod += (interval - linePeriod) / 8;
+    unexpectedIntervals = 0;
+  } else if (linePeriod == 0 || ++unexpectedIntervals >= RELEARN_THRESHOLD) {
+    linePeriod = interval;
+    unexpectedIntervals = 0;
+  }
+}
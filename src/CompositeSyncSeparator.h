@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+// Sync levels separated from a composite sync signal
+struct SeparatedSync {
+  bool hSyncActive = false;
+  bool vSyncActive = false;
+};
+
+// Software replacement of a sync separator like the LM1881: recovers horizontal and vertical sync from a single
+// composite sync channel. It only looks at the lengths of the runs between sync transitions, never at single samples.
+// - horizontal: sync pulses starting about a line after the previous line sync pass through, pulses in the middle of
+//   a line (equalizing pulses, serrations) are suppressed
+// - vertical: active from the end of the first broad pulse (longer than a fraction of the line) until the end of the
+//   first normal pulse following the broad ones
+// The line period is learned from the pulses; until then all pulses pass and there is no vertical sync.
+class CompositeSyncSeparator final {
+public:
+  // Levels for the next run of the composite sync signal (length samples at the same level)
+  auto separate(bool syncActive, uint64_t length) -> SeparatedSync;
+
+  [[nodiscard]] auto getLineLength() const -> double; // samples per line, 0 while not known yet
+
+private:
+  auto startPulse() -> void;
+  auto endPulse() -> void;
+  auto learnLinePeriod(double interval) -> void;
+
+  uint64_t position = 0; // start of the current run
+  bool inPulse = false;
+  uint64_t pulseLength = 0;
+  bool lineSyncPulse = false; // the current pulse starts a line
+  bool vSyncActive = false;
+  bool hasLineSync = false;
+  uint64_t lastLineSyncStart = 0;
+  double linePeriod = 0;
+  unsigned int unexpectedIntervals = 0;
+
+  static constexpr double HALF_LINE_LIMIT = 0.75;         // pulses before this fraction of a line are not line syncs
+  static constexpr double BROAD_PULSE = 0.2;              // pulses longer than this fraction of a line are vertical sync
+  static constexpr double TOLERANCE = 0.05;               // accepted deviation of the line period
+  static constexpr unsigned int RELEARN_THRESHOLD = 8;    // consecutive unexpected intervals to learn the period again
+};
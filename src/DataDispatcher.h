@@ -1,71 +1,271 @@
 #pragma once
 
+#include "SampleArena.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <mutex>
 #include <optional>
 #include <span>
+#include <vector>
 
-// Single element buffer for synchronizing one producer and one consumer.
-// When the consumer is too slow for the producer, the producer is blocked.
-// When the consumer is faster, it will be blocked until data gets available, but just for a certain time.
+// Bounded single-producer/single-consumer ring of owned sample blocks.
+// The producer copies incoming data into blocks of the dispatcher's arena (see SampleArena) and returns immediately. Head and tail indices are lock-free;
+// the mutex/condition variable is only touched when one side actually has to wait for the other.
+// When the ring is full, the producer either blocks (recorded sessions) or drops the block (live hardware).
+// Data that outlives the consumer (e.g. memory-mapped captures) can be passed without copying using putBorrowed().
 template <typename T>
 class DataDispatcher final {
 public:
+  enum class OverflowPolicy {
+    Block, // wait for the consumer (no data loss)
+    Drop,  // discard the new block and count an overrun (never stall the producer)
+  };
+
+  // Blocks dropped in a row
+  struct Gap {
+    uint64_t blockCount = 0;
+    uint64_t sampleCount = 0;
+  };
+
+  // blockBytes is the size of the arena blocks, data larger than that is split into several blocks
+  explicit DataDispatcher(
+    size_t slotCount = DEFAULT_SLOT_COUNT,
+    OverflowPolicy overflowPolicy = OverflowPolicy::Block,
+    size_t blockBytes = SampleArena<T>::DEFAULT_BLOCK_BYTES,
+    bool hugePages = false
+  ) : arena(blockBytes, std::max<size_t>(slotCount, 1) + SPARE_BLOCK_COUNT, hugePages),
+      slots(std::max<size_t>(slotCount, 1)),
+      mOverflowPolicy(overflowPolicy) {
+  }
+
   // To be called by producer:
-  // Put and wait until data was cleared by consumer.
-  auto put(T data) -> void {
-    std::unique_lock lk(dataMutex);
+  // Copy data into the next free slot(s). Returns false if (some of) the data was dropped (ring full or channel closed).
+  auto put(std::span<const T> data) -> bool {
+    return putConverted(data);
+  }
 
-    if (closed) {
-      return; // ignore passed data
+  // To be called by producer:
+  // Copy data of another sample width into the next free slot(s). Wider samples are truncated, which is fine as long
+  // as none of the upper channels are used.
+  template <typename U>
+  auto putConverted(std::span<const U> data) -> bool {
+    bool complete = true;
+    for (size_t offset = 0; offset < data.size();) {
+      auto slice = arena.acquire();
+      const auto count = std::min(data.size() - offset, slice.getCapacity());
+      std::transform(data.begin() + static_cast<std::ptrdiff_t>(offset), data.begin() + static_cast<std::ptrdiff_t>(offset + count), slice.getData(), [](U value) { return static_cast<T>(value); });
+      slice.setSize(count);
+      complete = putSlice(std::move(slice)) && complete;
+      offset += count;
     }
+    return complete;
+  }
 
-    mData.emplace(data);
-    conditionVariable.notify_all();
+  // To be called by producer:
+  // Hand over a filled block of the arena (see getArena()) without copying.
+  auto putSlice(typename SampleArena<T>::Slice slice) -> bool {
+    const auto size = slice.getSize();
+    return publish(size, [&slice](Slot& slot) {
+      slot.data = slice.getSamples();
+      slot.slice = std::move(slice);
+    });
+  }
 
-    conditionVariable.wait(lk, [this] { return !mData.has_value(); });
-    // We have to wait after emplacing and notifying because the driver frees the memory when returning.
+  // To be called by producer:
+  // Pass data without copying. The caller guarantees that it stays valid until the consumer is done.
+  auto putBorrowed(std::span<T> data) -> bool {
+    return publish(data.size(), [data](Slot& slot) {
+      slot.slice = typename SampleArena<T>::Slice();
+      slot.data = data;
+    });
   }
 
   // To be called by consumer:
-  // Get data. Returns empty std::optional when no data is available and readTimeout was reached.
-  std::optional<T> get(std::chrono::milliseconds readTimeout) {
-    std::unique_lock lk(dataMutex);
-    conditionVariable.wait_for(lk, readTimeout, [this] { return mData.has_value(); });
-    return mData;
+  // Get oldest block. Returns empty std::optional when no data is available and readTimeout was reached.
+  // The returned span stays valid until clear() is called.
+  std::optional<std::span<T>> get(std::chrono::milliseconds readTimeout) {
+    const auto head = headIndex.load(std::memory_order_relaxed);
+    if (tailIndex.load(std::memory_order_acquire) == head) {
+      auto hasData = [this, head] { return closed.load() || tailIndex.load() != head; };
+      waitUntil(consumerWaiting, consumerWaitNanoseconds, readTimeout, hasData);
+      if (tailIndex.load(std::memory_order_acquire) == head) {
+        return std::optional<std::span<T>>();
+      }
+    }
+
+    return slots[head % slots.size()].data;
   }
 
   // To be called by consumer:
-  // Clear data to allow producer to continue passing data.
+  // Blocks dropped right before the block returned by get(), so consumers that measure time in samples can skip them
+  [[nodiscard]] auto getGap() const -> Gap {
+    return slots[headIndex.load(std::memory_order_relaxed) % slots.size()].gap;
+  }
+
+  // To be called by consumer:
+  // Reference to the block returned by get() that keeps it valid after clear(), e.g. for processing it on another
+  // thread. Empty for borrowed data.
+  auto getSlice() -> typename SampleArena<T>::Slice {
+    return slots[headIndex.load(std::memory_order_relaxed) % slots.size()].slice;
+  }
+
+  // To be called by consumer:
+  // Release the block returned by get() so its slot can be reused by the producer.
   auto clear() -> void {
-    std::unique_lock lk(dataMutex);
-    mData.reset();
-    conditionVariable.notify_all();
+    const auto head = headIndex.load(std::memory_order_relaxed);
+    if (tailIndex.load(std::memory_order_acquire) == head) {
+      return; // nothing to release
+    }
+    slots[head % slots.size()].slice = typename SampleArena<T>::Slice(); // block returns to the arena unless retained
+    headIndex.store(head + 1);
+    wakeUp(producerWaiting);
   }
 
   // Close channel (producer has no more data or consumer doesn't want any more).
   auto close() -> void {
-    std::unique_lock lk(closedMutex);
-    closed = true;
-    clear(); // notifies producer
+    closed.store(true);
+    std::lock_guard lk(waitMutex);
+    conditionVariable.notify_all();
   }
 
   // Determine wether the channel has been closed.
   auto isClosed() -> bool {
-    std::unique_lock lk(closedMutex);
-    return closed;
+    return closed.load();
+  }
+
+  // Number of blocks currently waiting for the consumer.
+  [[nodiscard]] auto getOccupancy() const -> size_t {
+    return tailIndex.load(std::memory_order_relaxed) - headIndex.load(std::memory_order_relaxed);
+  }
+
+  // Maximum number of blocks that have been waiting at the same time.
+  [[nodiscard]] auto getHighWaterMark() const -> size_t {
+    return highWaterMark.load(std::memory_order_relaxed);
+  }
+
+  // Number of blocks that have been dropped because the ring was full.
+  [[nodiscard]] auto getOverrunCount() const -> uint64_t {
+    return overrunCount.load(std::memory_order_relaxed);
+  }
+
+  // Total time the producer was blocked because the ring was full.
+  [[nodiscard]] auto getProducerWaitNanoseconds() const -> uint64_t {
+    return producerWaitNanoseconds.load(std::memory_order_relaxed);
+  }
+
+  // Total time the consumer waited for data.
+  [[nodiscard]] auto getConsumerWaitNanoseconds() const -> uint64_t {
+    return consumerWaitNanoseconds.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto getCapacity() const -> size_t {
+    return slots.size();
+  }
+
+  // To be called by producer (and for statistics):
+  [[nodiscard]] auto getArena() -> SampleArena<T>& {
+    return arena;
+  }
+  [[nodiscard]] auto getArena() const -> const SampleArena<T>& {
+    return arena;
   }
 
+  static constexpr size_t DEFAULT_SLOT_COUNT = 32;
+
 private:
-  std::mutex dataMutex;
-  std::mutex closedMutex;
+  struct Slot {
+    typename SampleArena<T>::Slice slice; // owned data (empty for borrowed data)
+    std::span<T> data;
+    Gap gap; // dropped before this block
+  };
+
+  template <typename Fill>
+  auto publish(size_t sampleCount, Fill fill) -> bool {
+    if (closed.load()) {
+      return false; // ignore passed data
+    }
+
+    const auto tail = tailIndex.load(std::memory_order_relaxed);
+    if (tail - headIndex.load(std::memory_order_acquire) >= slots.size()) {
+      if (mOverflowPolicy == OverflowPolicy::Drop) {
+        overrunCount.fetch_add(1, std::memory_order_relaxed);
+        pendingGap.blockCount++;
+        pendingGap.sampleCount += sampleCount;
+        return false;
+      }
+      auto hasSpace = [this, tail] { return closed.load() || tail - headIndex.load() < slots.size(); };
+      while (!waitUntil(producerWaiting, producerWaitNanoseconds, WAIT_SLICE, hasSpace)) {
+      }
+      if (closed.load()) {
+        return false;
+      }
+    }
+
+    auto& slot = slots[tail % slots.size()];
+    fill(slot);
+    slot.gap = pendingGap;
+    pendingGap = Gap();
+    tailIndex.store(tail + 1);
+
+    const auto occupancy = tail + 1 - headIndex.load(std::memory_order_relaxed);
+    if (occupancy > highWaterMark.load(std::memory_order_relaxed)) {
+      highWaterMark.store(occupancy, std::memory_order_relaxed);
+    }
+
+    wakeUp(consumerWaiting);
+
+    return true;
+  }
+
+  // Block until predicate is true or timeout is reached. The waiting flag tells the other side that it has to notify.
+  template <typename Predicate>
+  auto waitUntil(std::atomic<bool>& waitingFlag, std::atomic<uint64_t>& waitNanoseconds, std::chrono::milliseconds timeout, Predicate predicate) -> bool {
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_lock lk(waitMutex);
+    waitingFlag.store(true);
+    auto result = conditionVariable.wait_for(lk, timeout, predicate);
+    waitingFlag.store(false);
+    waitNanoseconds.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+    return result;
+  }
+
+  auto wakeUp(std::atomic<bool>& waitingFlag) -> void {
+    if (waitingFlag.load()) {
+      std::lock_guard lk(waitMutex);
+      conditionVariable.notify_all();
+    }
+  }
+
+  SampleArena<T> arena; // outlives the slots
+  std::vector<Slot> slots;
+  const OverflowPolicy mOverflowPolicy;
+
+  // Monotonically increasing; slot = index % slots.size()
+  alignas(64) std::atomic<size_t> headIndex = 0; // written by consumer only
+  alignas(64) std::atomic<size_t> tailIndex = 0; // written by producer only
+
+  alignas(64) std::atomic<bool> closed = false;
+  std::atomic<bool> producerWaiting = false;
+  std::atomic<bool> consumerWaiting = false;
+  std::atomic<size_t> highWaterMark = 0;
+  std::atomic<uint64_t> overrunCount = 0;
+  std::atomic<uint64_t> producerWaitNanoseconds = 0;
+  std::atomic<uint64_t> consumerWaitNanoseconds = 0;
+  Gap pendingGap; // producer only: dropped since the last published block
+
+  std::mutex waitMutex;
   std::condition_variable conditionVariable;
-  std::optional<T> mData;
-  bool closed = false;
+
+  static constexpr std::chrono::milliseconds WAIT_SLICE = std::chrono::milliseconds(250);
+  static constexpr size_t SPARE_BLOCK_COUNT = 8; // blocks being filled by the producer or retained by the consumer
 };
 
-using Sample = uint8_t;
+using Sample = uint8_t;      // channels 0-7
+using WideSample = uint16_t; // channels 0-15
 using Samples = std::span<Sample>;
-using SampleDataDispatcher = DataDispatcher<Samples>;
+using SampleDataDispatcher = DataDispatcher<Sample>;
+using WideSampleDataDispatcher = DataDispatcher<WideSample>;
@@ -1,37 +1,59 @@
 #include "DataSource.h"
 #include "HardwareDataSource.h"
+#include "NativeCapture.h"
+#include "NativeCaptureDataSource.h"
 #include "RecordedSessionDataSource.h"
 #include <cstdint>
 #include <memory>
 
-DataSource::DataSource(
-  SampleDataDispatcher& dataDispatcher,
+template <typename T>
+DataSource<T>::DataSource(
+  DataDispatcher<T>& dataDispatcher,
   const DataSourceConfiguration& config
 ) : mDataDispatcher(dataDispatcher),
     mConfig(config),
     context(sigrok::Context::create()) {
 }
 
-auto DataSource::create(
-  SampleDataDispatcher& dataDispatcher,
-  const DataSourceConfiguration& config
+template <typename T>
+auto DataSource<T>::create(
+  DataDispatcher<T>& dataDispatcher,
+  const DataSourceConfiguration& config,
+  Statistics* statistics,
+  DataDispatcher<T>* recordDispatcher
 ) -> std::unique_ptr<DataSource> {
-  if (config.inputFile) {
-    return std::make_unique<RecordedSessionDataSource>(dataDispatcher, config);
+  std::unique_ptr<DataSource> dataSource;
+  if (config.inputFile && NativeCapture::isNativeCapture(config.inputFile.value())) {
+    dataSource = std::make_unique<NativeCaptureDataSource<T>>(dataDispatcher, config);
+  } else if (config.inputFile) {
+    dataSource = std::make_unique<RecordedSessionDataSource<T>>(dataDispatcher, config);
   } else {
-    return std::make_unique<HardwareDataSource>(dataDispatcher, config);
+    dataSource = std::make_unique<HardwareDataSource<T>>(dataDispatcher, config);
   }
+  dataSource->mStatistics = statistics;
+  dataSource->mRecordDispatcher = recordDispatcher;
+  dataSource->packetCoalescer.emplace(dataDispatcher, config.coalesceBytes, config.coalesceLatency, statistics);
+
+  return dataSource;
 }
 
-auto DataSource::getSampleRate() -> uint64_t {
+template <typename T>
+auto DataSource<T>::getSampleRate() -> uint64_t {
   return sampleRate;
 }
 
-auto DataSource::handlePacket(
+template <typename T>
+auto DataSource<T>::getChannelNames() -> const std::vector<std::string>& {
+  return channelNames;
+}
+
+template <typename T>
+auto DataSource<T>::handlePacket(
   [[maybe_unused]] std::shared_ptr<sigrok::Device> device,
   std::shared_ptr<sigrok::Packet> packet
 ) -> void {
   if (packet->type()->id() == SR_DF_END) {
+    packetCoalescer->flush();
     if (!mConfig.keepGoing) {
       mDataDispatcher.close();
     }
@@ -44,12 +66,40 @@ auto DataSource::handlePacket(
   if (logic->data_length() == 0) {
     throw std::runtime_error("Got packet with 0 samples.");
   }
-  if (logic->unit_size() > sizeof(Sample)) {
-    throw std::runtime_error("Size of received samples is bigger than expected.");
+  countPacket(logic->data_length());
+  // The data is copied (coalesced into larger blocks), so the driver may free its buffer as soon as we return.
+  const auto sampleCount = logic->data_length() / logic->unit_size();
+  packetCoalescer->add(logic->data_pointer(), logic->unit_size(), sampleCount);
+  if (mRecordDispatcher) {
+    putPacket(*mRecordDispatcher, logic->data_pointer(), logic->unit_size(), sampleCount); // dropped when the disk is too slow
   }
-  mDataDispatcher.put(Samples((Sample*)logic->data_pointer(), logic->data_length()));
   if (mDataDispatcher.isClosed()) {
     session->stop();
     session->remove_datafeed_callbacks();
   }
 }
+
+// Samples of other devices/files are widened or truncated (only the used channels have to fit into T).
+template <typename T>
+auto DataSource<T>::putPacket(DataDispatcher<T>& dataDispatcher, const void* data, unsigned int unitSize, size_t sampleCount) -> void {
+  if (unitSize == sizeof(T)) {
+    dataDispatcher.put(std::span<const T>(static_cast<const T*>(data), sampleCount));
+    return;
+  }
+  switch (unitSize) {
+    case 1:
+      dataDispatcher.putConverted(std::span<const uint8_t>(static_cast<const uint8_t*>(data), sampleCount));
+      break;
+    case 2:
+      dataDispatcher.putConverted(std::span<const uint16_t>(static_cast<const uint16_t*>(data), sampleCount));
+      break;
+    case 4:
+      dataDispatcher.putConverted(std::span<const uint32_t>(static_cast<const uint32_t*>(data), sampleCount));
+      break;
+    default:
+      throw std::runtime_error("Unsupported sample size of " + std::to_string(unitSize) + " bytes.");
+  }
+}
+
+template class DataSource<Sample>;
+template class DataSource<WideSample>;
@@ -1,40 +1,80 @@
 #pragma once
 
 #include "DataDispatcher.h"
+#include "PacketCoalescer.h"
+#include "Statistics.h"
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <libsigrokcxx/libsigrokcxx.hpp>
+#include <optional>
+#include <string>
+#include <vector>
 
 struct DataSourceConfiguration {
   uint64_t sampleRate = 12000000;
   std::optional<std::string> driverName = std::optional<std::string>();
+  unsigned int deviceIndex = 0; // among the logic analyzers found (of driverName, if given)
   std::set<uint8_t> enabledChannels = std::set<uint8_t>{0, 1, 2};
   std::optional<std::string> inputFile = std::optional<std::string>();
   bool keepGoing = false;
+  size_t coalesceBytes = 64 * 1024; // packets are collected into blocks of this size (0: passed on as they are)
+  std::chrono::milliseconds coalesceLatency = std::chrono::milliseconds(10); // maximum delay of coalesced samples
+  bool hugePages = false; // sample buffers (see SampleArena)
 };
 
+// Producer of samples of type T (Sample or WideSample). Packets of a different unit size are converted.
+template <typename T>
 class DataSource {
 public:
   virtual ~DataSource() = default;
   auto getSampleRate() -> uint64_t;
+  auto getChannelNames() -> const std::vector<std::string>&;
   virtual auto run() -> void = 0;
-  // Create new DataSource based on configuration
-  [[nodiscard]] static auto create(SampleDataDispatcher& dataDispatcher, const DataSourceConfiguration& config) -> std::unique_ptr<DataSource>;
+  // Create new DataSource based on configuration. Packets are only counted when statistics are passed.
+  // Packets of devices and recorded sessions are also passed to recordDispatcher, if any (should drop on overflow).
+  [[nodiscard]] static auto create(
+    DataDispatcher<T>& dataDispatcher,
+    const DataSourceConfiguration& config,
+    Statistics* statistics = nullptr,
+    DataDispatcher<T>* recordDispatcher = nullptr
+  ) -> std::unique_ptr<DataSource>;
 
 protected:
   DataSource(
-    SampleDataDispatcher& dataDispatcher,
+    DataDispatcher<T>& dataDispatcher,
     const DataSourceConfiguration& config
   );
+  // Count packet of the given size in bytes (when statistics are enabled)
+  inline auto countPacket(size_t size) -> void {
+    if (mStatistics) {
+      mStatistics->packetCount.fetch_add(1, std::memory_order_relaxed);
+      mStatistics->packetBytes.fetch_add(size, std::memory_order_relaxed);
+      mStatistics->packetSizes.add(size);
+    }
+  }
+  inline auto countBlock(size_t size) -> void {
+    if (mStatistics) {
+      mStatistics->blockCount.fetch_add(1, std::memory_order_relaxed);
+      mStatistics->blockSizes.add(size);
+    }
+  }
   // Packet handling common for all DataSources
   auto handlePacket(
     [[maybe_unused]] std::shared_ptr<sigrok::Device> device,
     std::shared_ptr<sigrok::Packet> packet
   ) -> void;
+  // Copy samples of the given unit size (in bytes) into a dispatcher
+  static auto putPacket(DataDispatcher<T>& dataDispatcher, const void* data, unsigned int unitSize, size_t sampleCount) -> void;
 
-  SampleDataDispatcher& mDataDispatcher;
+  DataDispatcher<T>& mDataDispatcher;
   const DataSourceConfiguration& mConfig;
+  Statistics* mStatistics = nullptr;
+  DataDispatcher<T>* mRecordDispatcher = nullptr;
+  std::optional<PacketCoalescer<T>> packetCoalescer; // for handlePacket()
 
   uint64_t sampleRate = 0;
+  std::vector<std::string> channelNames;
 
   std::shared_ptr<sigrok::Context> context = nullptr;
   std::shared_ptr<sigrok::Session> session = nullptr;
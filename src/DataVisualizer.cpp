@@ -1,112 +1,219 @@
 #include "DataVisualizer.h"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
 #include <thread>
+#include <utility>
 
-DataVisualizer::DataVisualizer(
-  SampleDataDispatcher& dataDispatcher,
-  const VisualizerConfiguration& config
-) : mDataDispatcher(dataDispatcher),
+namespace {
+
+auto getTileColumns(size_t streamCount) -> int {
+  return static_cast<int>(std::ceil(std::sqrt(static_cast<double>(std::max<size_t>(streamCount, 1)))));
+}
+
+auto getTileRows(size_t streamCount, int tileColumns) -> int {
+  return static_cast<int>((std::max<size_t>(streamCount, 1) + static_cast<size_t>(tileColumns) - 1) / static_cast<size_t>(tileColumns));
+}
+
+} // namespace
+
+template <typename T>
+DataVisualizer<T>::DataVisualizer(
+  std::vector<std::unique_ptr<StreamDecoder<T>>> streamDecoders,
+  const VisualizerConfiguration& config,
+  Statistics* statistics
+) : mStreamDecoders(std::move(streamDecoders)),
     mConfig(config),
-    sdlWrapper(mConfig.width, mConfig.height, "vidgrok"),
-    vSyncChannelMask(1 << mConfig.vSyncChannel),
-    hSyncChannelMask(1 << mConfig.hSyncChannel),
-    dataRedChannelMask(1 << mConfig.dataRedChannel),
-    dataGreenChannelMask(1 << mConfig.dataGreenChannel),
-    dataBlueChannelMask(1 << mConfig.dataBlueChannel) {
+    mStatistics(statistics),
+    tileColumns(getTileColumns(mStreamDecoders.size())),
+    sdlWrapper(mConfig.width * tileColumns, mConfig.height * getTileRows(mStreamDecoders.size(), tileColumns), "vidgrok") {
+  if (mStatistics) {
+    overlaySnapshot = mStatistics->snapshot();
+  }
 }
 
-auto DataVisualizer::run() -> void {
-  while (true) {
-    auto optionalData = mDataDispatcher.get(std::chrono::milliseconds(250));
-    if (optionalData) {
-      process(optionalData.value());
-      mDataDispatcher.clear();
-    }
+template <typename T>
+auto DataVisualizer<T>::run() -> std::optional<VideoMode> {
+  // With several streams, decoder threads are spread over the cores (leaving the first one to this thread)
+  for (size_t i = 0; i < mStreamDecoders.size(); i++) {
+    mStreamDecoders[i]->start(mStreamDecoders.size() > 1 ? std::optional<unsigned int>(static_cast<unsigned int>(i + 1)) : std::optional<unsigned int>());
+  }
 
-    // When packets are coming in slowly, we render to refresh the window content, even if there is no new data
-    if (!mConfig.renderSynced && std::chrono::steady_clock::now() >= lastRenderedAt + MINIMAL_RENDER_PAUSE) {
-      render();
-    }
+  try {
+    auto lastRenderedAt = std::chrono::steady_clock::now();
+    while (true) {
+      const auto now = std::chrono::steady_clock::now();
+      const bool finished = std::all_of(mStreamDecoders.begin(), mStreamDecoders.end(), [](const auto& streamDecoder) { return streamDecoder->isFinished(); });
+      const bool newFrame = present();
+      if (mStatistics && now >= overlaySnapshot.time + OVERLAY_UPDATE_INTERVAL) {
+        updateOverlay();
+      }
+      if (now >= titleUpdatedAt + TITLE_UPDATE_INTERVAL) {
+        updateTitle();
+        titleUpdatedAt = now;
+      }
+      // Re-render without new frame from time to time to keep the window content intact
+      if (newFrame || now >= lastRenderedAt + WINDOW_REFRESH_INTERVAL) {
+        ScopedTimer timer(mStatistics, &Statistics::renderNanoseconds);
+        sdlWrapper.render(mStatistics && overlayVisible ? overlayText : std::vector<std::string>());
+        lastRenderedAt = now;
+      }
 
-    if (mDataDispatcher.isClosed()) {
-      break;
-    }
+      if (finished && !newFrame) {
+        break; // producers have no more data and everything has been drawn
+      }
 
-    if (sdlWrapper.quitEventOccured()) {
-      mDataDispatcher.close();
-      break;
+      if (!handleEvents()) {
+        break;
+      }
+
+      std::this_thread::sleep_for(PRESENTER_POLL_INTERVAL);
     }
+  } catch (...) {
+    stopDecoders();
+    throw;
   }
-}
 
-auto DataVisualizer::process(Samples samples) -> void {
-  Pixel* pixels = nullptr;
+  std::optional<VideoMode> changedVideoMode;
+  for (const auto& streamDecoder : mStreamDecoders) {
+    if (streamDecoder->isFinished() && streamDecoder->getChangedVideoMode()) {
+      changedVideoMode = streamDecoder->getChangedVideoMode();
+    }
+  }
+  if (!changedVideoMode) {
+    stopDecoders();
+  }
+  for (auto& streamDecoder : mStreamDecoders) {
+    streamDecoder->join();
+  }
 
-  sdlWrapper.lockTexture(&pixels);
+  if (mConfig.syncLock) {
+    for (const auto& streamDecoder : mStreamDecoders) {
+      std::cerr << streamDecoder->getSyncLock().getSummary() << std::endl;
+    }
+  }
 
-  for (auto& sample : samples) {
-    bool vSyncActive = mConfig.invertVSync == (sample & vSyncChannelMask);
-    bool hSyncActive = mConfig.invertHSync == (sample & hSyncChannelMask);
-    bool verticalTriggered = !mConfig.disableVSync && previousSampleVSyncActive && !vSyncActive;
-    bool horizontalTriggered = !mConfig.disableHSync && previousSampleHSyncActive && !hSyncActive;
+  return changedVideoMode;
+}
 
-    if (horizontalTriggered) {
-      position = position - (position % mConfig.width) + mConfig.width; // start of next line
+// Upload the changed tiles of new frames. Returns true when any stream had a new frame.
+template <typename T>
+auto DataVisualizer<T>::present() -> bool {
+  bool newFrame = false;
+  for (size_t i = 0; i < mStreamDecoders.size(); i++) {
+    auto frame = mStreamDecoders[i]->acquire();
+    if (!frame) {
+      continue;
     }
-
-    if (verticalTriggered) {
-      position = 0; // start of frame
-      if (mConfig.renderSynced) {
-        sdlWrapper.unlockTexture();
-        render();
-        sdlWrapper.lockTexture(&pixels);
-      }
+    {
+      ScopedTimer timer(mStatistics, &Statistics::textureUploadNanoseconds);
+      sdlWrapper.updateTexture(getTileArea(i), frame->pixels, frame->dirtyTiles, FrameDifference::TILE_SIZE);
     }
+    if (mStatistics) {
+      mStatistics->presentedFrameCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    newFrame = true;
+  }
 
-    pixels[position] = getPixelValue(vSyncActive, hSyncActive, sample);
+  return newFrame;
+}
 
-    previousSampleHSyncActive = hSyncActive;
-    previousSampleVSyncActive = vSyncActive;
+template <typename T>
+auto DataVisualizer<T>::stopDecoders() -> void {
+  for (auto& streamDecoder : mStreamDecoders) {
+    streamDecoder->stop();
+  }
+}
 
-    position++;
-    samplesSinceLastRendering++;
-    if (position > mConfig.width * mConfig.height) {
-      position = 0;
+// Returns false when the window has been closed.
+template <typename T>
+auto DataVisualizer<T>::handleEvents() -> bool {
+  const auto events = sdlWrapper.pollEvents();
+  for (const auto key : events.pressedKeys) {
+    if (key == SDLK_s && mStatistics) {
+      overlayVisible = !overlayVisible;
+      sdlWrapper.render(overlayVisible ? overlayText : std::vector<std::string>());
+    }
+    for (const auto& streamDecoder : mStreamDecoders) {
+      if (auto* player = streamDecoder->getPlayer()) {
+        controlPlayer(*player, key);
+      }
     }
   }
 
-  sdlWrapper.unlockTexture();
+  return !events.quit;
 }
 
-auto DataVisualizer::getPixelValue(bool vSyncActive, bool hSyncActive, Sample data) -> Pixel {
-  Pixel value = 0;
-  if (mConfig.highlightVSync && vSyncActive) {
-    value |= 0x3f0000ff;
+template <typename T>
+auto DataVisualizer<T>::controlPlayer(CapturePlayer<T>& player, SDL_Keycode key) -> void {
+  switch (key) {
+    case SDLK_SPACE:
+      player.togglePause();
+      break;
+    case SDLK_LEFT:
+      player.step(-1);
+      break;
+    case SDLK_RIGHT:
+      player.step(1);
+      break;
+    case SDLK_PAGEUP:
+      player.skip(-PLAYER_SKIP_FRAMES);
+      break;
+    case SDLK_PAGEDOWN:
+      player.skip(PLAYER_SKIP_FRAMES);
+      break;
+    case SDLK_HOME:
+      player.seek(0);
+      break;
+    case SDLK_PLUS:
+    case SDLK_KP_PLUS:
+    case SDLK_EQUALS: // plus without shift on many layouts
+      player.changeSpeed(2);
+      break;
+    case SDLK_MINUS:
+    case SDLK_KP_MINUS:
+      player.changeSpeed(0.5);
+      break;
+    case SDLK_u:
+      player.toggleUnthrottled();
+      break;
+    default:
+      break;
   }
-  if (mConfig.highlightHSync && hSyncActive) {
-    value |= 0x00003fff;
+  updateTitle();
+}
+
+template <typename T>
+auto DataVisualizer<T>::updateTitle() -> void {
+  std::string newTitle = "vidgrok";
+  for (const auto& streamDecoder : mStreamDecoders) {
+    if (const auto* player = streamDecoder->getPlayer()) {
+      newTitle += " - " + player->getStatus();
+    }
   }
-  if ((!vSyncActive && !hSyncActive) || mConfig.renderHiddenData) {
-    value |= ((bool)(data & dataRedChannelMask) != mConfig.invertData) ? 0xff0000ff : 0x00000000;
-    value |= ((bool)(data & dataGreenChannelMask) != mConfig.invertData) ? 0x00ff00ff : 0x00000000;
-    value |= ((bool)(data & dataBlueChannelMask) != mConfig.invertData) ? 0x0000ffff : 0x00000000;
+  if (newTitle != title) {
+    sdlWrapper.setTitle(newTitle);
+    title = newTitle;
   }
+}
 
-  return value;
+template <typename T>
+auto DataVisualizer<T>::updateOverlay() -> void {
+  const auto snapshot = mStatistics->snapshot();
+  overlayText = Statistics::toText(snapshot, overlaySnapshot);
+  overlaySnapshot = snapshot;
 }
 
-// Render data (the texture is expected to be locked!)
-auto DataVisualizer::render() -> void {
-  sdlWrapper.render();
-
-  // Add pause to slow down visualization to match real time (important for recorded sessions)
-  auto recordingDuration = std::chrono::nanoseconds(1000000000 * samplesSinceLastRendering / mConfig.sampleRate);
-  auto now = std::chrono::steady_clock::now();
-  auto renderingDuration = now - lastRenderedAt;
-  auto additionalWaitTime = recordingDuration - renderingDuration;
-  if (additionalWaitTime.count() > 0) {
-    std::this_thread::sleep_for(additionalWaitTime);
-  }
-  lastRenderedAt = now;
-  samplesSinceLastRendering = 0;
+// Position of a stream within the window texture
+template <typename T>
+auto DataVisualizer<T>::getTileArea(size_t stream) const -> SDL_Rect {
+  const auto column = static_cast<int>(stream % static_cast<size_t>(tileColumns));
+  const auto row = static_cast<int>(stream / static_cast<size_t>(tileColumns));
+
+  return {column * mConfig.width, row * mConfig.height, mConfig.width, mConfig.height};
 }
+
+template class DataVisualizer<Sample>;
+template class DataVisualizer<WideSample>;
@@ -1,61 +1,60 @@
 #pragma once
 
-#include "DataDispatcher.h"
 #include "SdlWrapper.h"
+#include "Statistics.h"
+#include "StreamDecoder.h"
+#include "VisualizerConfiguration.h"
 #include <chrono>
-#include <cstdint>
-
-// Default values should be OK for PAL video
-struct VisualizerConfiguration {
-  int width = 800;
-  int height = 330;
-  uint8_t vSyncChannel = 0;
-  uint8_t hSyncChannel = 1;
-  uint8_t dataRedChannel = 2;
-  uint8_t dataGreenChannel = 2;
-  uint8_t dataBlueChannel = 2;
-  bool invertData = false;
-  bool invertVSync = false;
-  bool invertHSync = false;
-  bool disableVSync = false;
-  bool disableHSync = false;
-  bool highlightVSync = false;
-  bool highlightHSync = false;
-  bool renderHiddenData = false;
-  bool renderSynced = false;
-  uint64_t sampleRate = 0; // not configurable via command line arguments
-};
-
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Presents the newest complete frames of one or more streams in an SDL window. Each stream is decoded on its own
+// thread (see StreamDecoder) and shown in its own tile, so a slow stream doesn't stall the others.
+// Only the changed tiles of a frame are uploaded.
+// With statistics, an overlay showing them can be toggled with the S key.
+// A stream played from a capture player is controlled with the keyboard, its status is shown in the window title.
+template <typename T>
 class DataVisualizer final {
 public:
   DataVisualizer(
-    SampleDataDispatcher& dataDispatcher,
-    const VisualizerConfiguration& config
+    std::vector<std::unique_ptr<StreamDecoder<T>>> streamDecoders,
+    const VisualizerConfiguration& config,
+    Statistics* statistics = nullptr
   );
 
-  // Main loop: Fetches new samples (if available), processes/renders them and handles events.
-  auto run() -> void;
+  // Main loop: Presents frames and handles events while the decoder threads process the samples.
+  // Returns the new video mode when a stream changed it (auto mode), the caller may then continue with a new
+  // visualizer for it.
+  auto run() -> std::optional<VideoMode>;
 
 private:
-  inline auto process(Samples samples) -> void;
-  [[nodiscard]] inline auto getPixelValue(bool vSyncActive, bool hSyncActive, Sample data) -> Pixel;
-  inline auto render() -> void;
-
-  SampleDataDispatcher& mDataDispatcher;
+  auto present() -> bool;
+  auto stopDecoders() -> void;
+  auto handleEvents() -> bool;
+  auto controlPlayer(CapturePlayer<T>& player, SDL_Keycode key) -> void;
+  auto updateTitle() -> void;
+  auto updateOverlay() -> void;
+  [[nodiscard]] auto getTileArea(size_t stream) const -> SDL_Rect;
+
+  std::vector<std::unique_ptr<StreamDecoder<T>>> mStreamDecoders;
   const VisualizerConfiguration& mConfig;
+  Statistics* mStatistics;
+  const int tileColumns; // streams are arranged in a grid
 
   SdlWrapper sdlWrapper;
 
-  const Sample vSyncChannelMask = 0;
-  const Sample hSyncChannelMask = 0;
-  const Sample dataRedChannelMask = 0;
-  const Sample dataGreenChannelMask = 0;
-  const Sample dataBlueChannelMask = 0;
-  long int position = 0;
-  long int samplesSinceLastRendering = 0;
-  bool previousSampleVSyncActive = false;
-  bool previousSampleHSyncActive = false;
-  std::chrono::time_point<std::chrono::steady_clock> lastRenderedAt = std::chrono::steady_clock::now();
-
-  const std::chrono::milliseconds MINIMAL_RENDER_PAUSE = std::chrono::milliseconds(20); // = 50 fps
+  bool overlayVisible = true;
+  std::vector<std::string> overlayText;
+  StatisticsSnapshot overlaySnapshot;
+  std::string title;
+  std::chrono::time_point<std::chrono::steady_clock> titleUpdatedAt;
+
+  const std::chrono::milliseconds PRESENTER_POLL_INTERVAL = std::chrono::milliseconds(4);
+  const std::chrono::milliseconds WINDOW_REFRESH_INTERVAL = std::chrono::milliseconds(250);
+  const std::chrono::milliseconds OVERLAY_UPDATE_INTERVAL = std::chrono::milliseconds(500);
+  const std::chrono::milliseconds TITLE_UPDATE_INTERVAL = std::chrono::milliseconds(100);
+  const long int PLAYER_SKIP_FRAMES = 50; // page up/down
 };
@@ -0,0 +1,60 @@
+#include "Decimator.h"
+#include <algorithm>
+#include <cstddef>
+
+template <typename T>
+Decimator<T>::Decimator(const VisualizerConfiguration& config, const PixelConverter<T>& pixelConverter)
+  : mPixelConverter(pixelConverter),
+    factor(std::max(config.decimation, 1U)),
+    boxFilter(config.boxFilter) {
+}
+
+template <typename T>
+auto Decimator<T>::convert(std::span<const T> samples, unsigned int phase, Pixel* pixels) -> void {
+  if (factor == 1) {
+    mPixelConverter.convert(samples, pixels);
+  } else if (boxFilter) {
+    average(samples, phase, pixels);
+  } else {
+    pick(samples, phase, pixels);
+  }
+}
+
+// Only the first sample of each group is converted
+template <typename T>
+auto Decimator<T>::pick(std::span<const T> samples, unsigned int phase, Pixel* pixels) -> void {
+  const size_t first = phase == 0 ? 0 : factor - phase;
+  pickedSamples.clear();
+  for (size_t i = first; i < samples.size(); i += factor) {
+    pickedSamples.push_back(samples[i]);
+  }
+  mPixelConverter.convert(pickedSamples, pixels + (phase == 0 ? 0 : 1));
+}
+
+// All samples are converted by the lookup table kernel, then the components are averaged per group.
+// The pixel of an incomplete group is written once its last sample arrives.
+template <typename T>
+auto Decimator<T>::average(std::span<const T> samples, unsigned int phase, Pixel* pixels) -> void {
+  groupPixels.resize(samples.size());
+  mPixelConverter.convert(samples, groupPixels.data());
+
+  for (const Pixel pixel : groupPixels) {
+    if (phase == 0) {
+      sums = {};
+    }
+    for (size_t component = 0; component < sums.size(); component++) {
+      sums[component] += (pixel >> (component * 8)) & 0xff;
+    }
+    if (++phase == factor) {
+      Pixel result = 0;
+      for (size_t component = 0; component < sums.size(); component++) {
+        result |= (sums[component] / factor) << (component * 8);
+      }
+      *pixels++ = result;
+      phase = 0;
+    }
+  }
+}
+
+template class Decimator<Sample>;
+template class Decimator<WideSample>;
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "PixelConverter.h"
+#include "SdlWrapper.h"
+#include "VisualizerConfiguration.h"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Horizontal decimation: every group of config.decimation consecutive samples becomes one pixel, either by picking
+// the first sample of the group or by averaging the converted pixels of the whole group (box filter).
+// Groups may be split across calls: phase is the number of samples of the current group that were already passed.
+template <typename T>
+class Decimator final {
+public:
+  Decimator(const VisualizerConfiguration& config, const PixelConverter<T>& pixelConverter);
+
+  // pixels points to the pixel of the group that samples[0] belongs to. Writes (phase + samples.size()) / decimation
+  // pixels at most (plus the one of an incomplete group that has been picked already).
+  auto convert(std::span<const T> samples, unsigned int phase, Pixel* pixels) -> void;
+
+  [[nodiscard]] auto getFactor() const -> unsigned int {
+    return factor;
+  }
+
+private:
+  auto pick(std::span<const T> samples, unsigned int phase, Pixel* pixels) -> void;
+  auto average(std::span<const T> samples, unsigned int phase, Pixel* pixels) -> void;
+
+  const PixelConverter<T>& mPixelConverter;
+  const unsigned int factor;
+  const bool boxFilter;
+
+  std::vector<T> pickedSamples;     // scratch buffer, capacity is reused
+  std::vector<Pixel> groupPixels;   // scratch buffer, capacity is reused
+  std::array<uint32_t, 4> sums = {}; // per color component of the current group
+};
@@ -0,0 +1,147 @@
+#include "FrameAccumulator.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+FrameAccumulator::FrameAccumulator(size_t pixelCount, Persistence persistence, unsigned int frames)
+  : mPersistence(persistence),
+    mFrames(frames),
+    decayShift(std::min(static_cast<unsigned int>(std::bit_width(std::max(frames, 1U))) - 1, 8U)),
+    averageShift(static_cast<unsigned int>(std::bit_width(std::max(frames, 2U) - 1)) - 1),
+    averageReciprocal(static_cast<uint16_t>(((uint64_t(1) << (16 + averageShift)) + frames - 1) / std::max(frames, 2U))),
+    output(pixelCount, 0) {
+  if (frames < 2 || frames > MAX_FRAMES) {
+    throw std::runtime_error("Number of persistence frames must be between 2 and " + std::to_string(MAX_FRAMES) + ".");
+  }
+  const auto componentCount = pixelCount * sizeof(Pixel);
+  if (mPersistence == Persistence::Decay || mPersistence == Persistence::Average) {
+    sums.resize(componentCount);
+  }
+  if (mPersistence == Persistence::Average) {
+    history.resize(componentCount * mFrames);
+  }
+}
+
+auto FrameAccumulator::accumulate(std::span<const Pixel> frame) -> std::span<const Pixel> {
+  const std::span<const uint8_t> input(reinterpret_cast<const uint8_t*>(frame.data()), std::min(frame.size(), output.size()) * sizeof(Pixel));
+  if (!started) {
+    start(input);
+    started = true;
+    return output;
+  }
+
+  switch (mPersistence) {
+    case Persistence::Decay:
+      decay(input);
+      break;
+    case Persistence::Average:
+      average(input);
+      break;
+    case Persistence::MaxHold:
+      maxHold(input);
+      break;
+    case Persistence::Off:
+      std::copy(input.begin(), input.end(), reinterpret_cast<uint8_t*>(output.data()));
+      break;
+  }
+
+  return output;
+}
+
+// The first frame initializes everything as if it had been shown forever (the image doesn't fade in from black).
+auto FrameAccumulator::start(std::span<const uint8_t> input) -> void {
+  std::copy(input.begin(), input.end(), reinterpret_cast<uint8_t*>(output.data()));
+  for (size_t i = 0; i < sums.size(); i++) {
+    sums[i] = static_cast<uint16_t>(mPersistence == Persistence::Decay ? input[i] << 8 : input[i] * mFrames);
+  }
+  for (size_t frame = 0; frame < history.size() / input.size(); frame++) {
+    std::copy(input.begin(), input.end(), history.begin() + static_cast<std::ptrdiff_t>(frame * input.size()));
+  }
+}
+
+// sum = sum - sum / 2^k + input * 2^8 / 2^k (converges to input * 2^8)
+auto FrameAccumulator::decay(std::span<const uint8_t> input) -> void {
+  auto* result = reinterpret_cast<uint8_t*>(output.data());
+  size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(decayShift));
+  const __m128i inputShift = _mm_cvtsi32_si128(static_cast<int>(8 - decayShift));
+  for (; i + 16 <= input.size(); i += 16) {
+    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&sums[i]));
+    __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&sums[i + 8]));
+    low = _mm_add_epi16(_mm_sub_epi16(low, _mm_srl_epi16(low, shift)), _mm_sll_epi16(_mm_unpacklo_epi8(values, zero), inputShift));
+    high = _mm_add_epi16(_mm_sub_epi16(high, _mm_srl_epi16(high, shift)), _mm_sll_epi16(_mm_unpackhi_epi8(values, zero), inputShift));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&sums[i]), low);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&sums[i + 8]), high);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&result[i]), _mm_packus_epi16(_mm_srli_epi16(low, 8), _mm_srli_epi16(high, 8)));
+  }
+#endif
+
+  for (; i < input.size(); i++) {
+    sums[i] = static_cast<uint16_t>(sums[i] - (sums[i] >> decayShift) + (input[i] << (8 - decayShift)));
+    result[i] = static_cast<uint8_t>(sums[i] >> 8);
+  }
+}
+
+// The sum of the history is updated by the difference of the new and the oldest frame, the (rounded) mean is then
+// calculated by multiplying with the reciprocal of the frame count (off by one at most).
+auto FrameAccumulator::average(std::span<const uint8_t> input) -> void {
+  auto* result = reinterpret_cast<uint8_t*>(output.data());
+  auto* oldest = history.data() + historyIndex * input.size();
+  const auto half = static_cast<uint16_t>(mFrames / 2);
+  size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i halfValues = _mm_set1_epi16(static_cast<short>(half));
+  const __m128i reciprocal = _mm_set1_epi16(static_cast<short>(averageReciprocal));
+  const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(averageShift));
+  for (; i + 16 <= input.size(); i += 16) {
+    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+    const __m128i oldValues = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&oldest[i]));
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&sums[i]));
+    __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&sums[i + 8]));
+    low = _mm_sub_epi16(_mm_add_epi16(low, _mm_unpacklo_epi8(values, zero)), _mm_unpacklo_epi8(oldValues, zero));
+    high = _mm_sub_epi16(_mm_add_epi16(high, _mm_unpackhi_epi8(values, zero)), _mm_unpackhi_epi8(oldValues, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&sums[i]), low);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&sums[i + 8]), high);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&oldest[i]), values);
+    const __m128i lowMean = _mm_srl_epi16(_mm_mulhi_epu16(_mm_add_epi16(low, halfValues), reciprocal), shift);
+    const __m128i highMean = _mm_srl_epi16(_mm_mulhi_epu16(_mm_add_epi16(high, halfValues), reciprocal), shift);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&result[i]), _mm_packus_epi16(lowMean, highMean));
+  }
+#endif
+
+  for (; i < input.size(); i++) {
+    sums[i] = static_cast<uint16_t>(sums[i] + input[i] - oldest[i]);
+    oldest[i] = input[i];
+    result[i] = static_cast<uint8_t>((static_cast<uint32_t>(sums[i] + half) * averageReciprocal) >> (16 + averageShift));
+  }
+
+  historyIndex = (historyIndex + 1) % mFrames;
+}
+
+auto FrameAccumulator::maxHold(std::span<const uint8_t> input) -> void {
+  auto* result = reinterpret_cast<uint8_t*>(output.data());
+  size_t i = 0;
+
+#ifdef __SSE2__
+  for (; i + 16 <= input.size(); i += 16) {
+    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+    const __m128i held = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&result[i]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&result[i]), _mm_max_epu8(values, held));
+  }
+#endif
+
+  for (; i < input.size(); i++) {
+    result[i] = std::max(result[i], input[i]);
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "SdlWrapper.h"
+#include "VisualizerConfiguration.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Combines completed frames into a persistent image, so noisy signals don't flicker:
+// - Decay: exponential moving average with a weight of 1/frames for the new frame (frames rounded to a power of two)
+// - Average: mean of the last frames
+// - MaxHold: brightest value of every color component since the start
+// The color components are blended independently in 8.8 fixed point (16 bit per component), 16 of them at once with
+// SSE2. A frame costs a single pass over the pixels.
+class FrameAccumulator final {
+public:
+  FrameAccumulator(size_t pixelCount, Persistence persistence, unsigned int frames);
+
+  // Blend in a completed frame. Returns the accumulated image (valid until the next call).
+  auto accumulate(std::span<const Pixel> frame) -> std::span<const Pixel>;
+
+  [[nodiscard]] auto getFrame() const -> std::span<const Pixel> {
+    return output;
+  }
+
+  static constexpr unsigned int MAX_FRAMES = 256; // sums of 8 bit values still fit into 16 bit
+
+private:
+  auto start(std::span<const uint8_t> input) -> void;
+  auto decay(std::span<const uint8_t> input) -> void;
+  auto average(std::span<const uint8_t> input) -> void;
+  auto maxHold(std::span<const uint8_t> input) -> void;
+
+  const Persistence mPersistence;
+  const unsigned int mFrames;
+  const unsigned int decayShift;    // log2 of the decay time constant
+  const unsigned int averageShift;  // division by multiplication: mean = (sum * reciprocal) >> (16 + shift)
+  const uint16_t averageReciprocal; // 2^(16 + shift) / frames (rounded up)
+  std::vector<Pixel> output;
+  std::vector<uint16_t> sums;   // per color component: 8.8 fixed point (decay) or sum of the history (average)
+  std::vector<uint8_t> history; // average: the last frames (ring)
+  size_t historyIndex = 0;
+  bool started = false;
+};
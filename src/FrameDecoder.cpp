@@ -0,0 +1,207 @@
+#include "FrameDecoder.h"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+template <typename T>
+FrameDecoder<T>::FrameDecoder(
+  const VisualizerConfiguration& config,
+  FrameCompletedCallback frameCompletedCallback
+) : mConfig(config),
+    mFrameCompletedCallback(std::move(frameCompletedCallback)),
+    vSyncChannelMask(static_cast<T>(1 << mConfig.vSyncChannel)),
+    hSyncChannelMask(static_cast<T>(1 << mConfig.hSyncChannel)),
+    frameSize(static_cast<long int>(mConfig.width) * mConfig.height),
+    transitionDecoder(mConfig.compositeSync ? hSyncChannelMask : static_cast<T>(vSyncChannelMask | hSyncChannelMask)),
+    pixelConverter(mConfig),
+    decimator(mConfig, pixelConverter),
+    resampler(mConfig.width, pixelConverter),
+    resampling(mConfig.linePixels > 0),
+    cropped(mConfig.cropLeft > 0 || mConfig.cropTop > 0 || resampling),
+    windowEnd(resampling ? mConfig.cropLeft : mConfig.cropLeft + static_cast<long int>(mConfig.width) * decimator.getFactor()) {
+  for (long int i = 0; i < mConfig.height; i++) {
+    lineOffsets.push_back(i * mConfig.width);
+  }
+}
+
+template <typename T>
+auto FrameDecoder<T>::setTarget(Pixel* pixels) -> void {
+  mPixels = pixels;
+}
+
+template <typename T>
+auto FrameDecoder<T>::decode(std::span<T> samples) -> void {
+  // Runs are split on sync transitions only: sync handling happens once per run, the data within a run is
+  // converted by the vectorized lookup table kernel.
+  size_t offset = 0;
+  for (const auto& run : transitionDecoder.decode(samples)) {
+    const T sample = run.value;
+    const auto runSamples = samples.subspan(offset, run.length);
+    offset += run.length;
+    bool vSyncActive = mConfig.invertVSync == static_cast<bool>(sample & vSyncChannelMask);
+    bool hSyncActive = mConfig.invertHSync == static_cast<bool>(sample & hSyncChannelMask);
+    if (mConfig.compositeSync) {
+      const auto separated = compositeSyncSeparator.separate(hSyncActive, run.length);
+      vSyncActive = separated.vSyncActive;
+      hSyncActive = separated.hSyncActive;
+    }
+    bool verticalTriggered = !mConfig.disableVSync && previousSampleVSyncActive && !vSyncActive;
+    bool horizontalTriggered = !mConfig.disableHSync && previousSampleHSyncActive && !hSyncActive;
+
+    if (horizontalTriggered) {
+      if (mConfig.syncLock) {
+        startLine(syncLock.horizontalEdge(decodedSampleCount));
+      } else if (cropped) {
+        if (resampling) {
+          syncLock.horizontalEdge(decodedSampleCount); // only for the line period
+        }
+        startLine(SyncLock::HorizontalEdge::NewLine);
+      } else {
+        position = position - (position % mConfig.width) + mConfig.width; // start of next line
+        phase = 0;
+      }
+    }
+
+    if (verticalTriggered && (!mConfig.syncLock || syncLock.verticalEdge(decodedSampleCount))) {
+      startFrame();
+      if (mFrameCompletedCallback) {
+        mFrameCompletedCallback();
+      }
+    }
+
+    if (mConfig.syncLock) {
+      writeLocked(runSamples);
+    } else if (cropped) {
+      writeWindow(runSamples);
+    } else {
+      write(runSamples);
+    }
+
+    previousSampleHSyncActive = hSyncActive;
+    previousSampleVSyncActive = vSyncActive;
+
+    decodedSampleCount += run.length;
+  }
+}
+
+template <typename T>
+auto FrameDecoder<T>::reset(T previousSample) -> void {
+  startFrame();
+  syncLock = SyncLock();
+  compositeSyncSeparator = CompositeSyncSeparator();
+  previousSampleVSyncActive = mConfig.invertVSync == static_cast<bool>(previousSample & vSyncChannelMask);
+  previousSampleHSyncActive = mConfig.invertHSync == static_cast<bool>(previousSample & hSyncChannelMask);
+}
+
+template <typename T>
+auto FrameDecoder<T>::getDecodedSampleCount() const -> uint64_t {
+  return decodedSampleCount;
+}
+
+template <typename T>
+auto FrameDecoder<T>::getSyncLock() const -> const SyncLock& {
+  return syncLock;
+}
+
+// Samples continue on the next line when exceeding the width
+template <typename T>
+auto FrameDecoder<T>::write(std::span<T> samples) -> void {
+  const auto factor = decimator.getFactor();
+  size_t converted = 0;
+  while (converted < samples.size()) {
+    if (position >= frameSize) {
+      position = 0;
+    }
+    const auto count = std::min(samples.size() - converted, static_cast<size_t>(frameSize - position) * factor - phase);
+    decimator.convert(samples.subspan(converted, count), phase, mPixels + position);
+    position += static_cast<long int>((phase + count) / factor);
+    phase = static_cast<unsigned int>((phase + count) % factor);
+    converted += count;
+  }
+}
+
+// Lines are started at sync edges or, when these are missing, at the predicted position.
+// Samples exceeding the width are not drawn.
+template <typename T>
+auto FrameDecoder<T>::writeLocked(std::span<T> samples) -> void {
+  const uint64_t start = decodedSampleCount;
+  size_t converted = 0;
+  while (converted < samples.size()) {
+    auto count = samples.size() - converted;
+    if (syncLock.isLocked()) {
+      const uint64_t current = start + converted;
+      const uint64_t nextLineStart = syncLock.getNextLineStart();
+      if (nextLineStart <= current) {
+        syncLock.lineStartedByPrediction();
+        startLine(SyncLock::HorizontalEdge::NewLine);
+        continue;
+      }
+      count = std::min(count, static_cast<size_t>(nextLineStart - current));
+    }
+    writeWindow(samples.subspan(converted, count));
+    converted += count;
+  }
+}
+
+// Converts the part of the samples (all from the current line) that falls into the crop window.
+// Samples left/right of it and whole lines above/below it are skipped without looking at them.
+template <typename T>
+auto FrameDecoder<T>::writeWindow(std::span<T> samples) -> void {
+  const auto count = static_cast<long int>(samples.size());
+  const auto begin = std::clamp(mConfig.cropLeft - column, 0L, count);
+  const auto end = std::clamp(windowEnd - column, 0L, count);
+  if (line >= 0 && begin < end && resampling) {
+    resampler.convert(samples.subspan(begin, end - begin), column + begin - mConfig.cropLeft, mPixels + lineOffsets[line]);
+  } else if (line >= 0 && begin < end) {
+    const auto factor = decimator.getFactor();
+    const auto windowColumn = column + begin - mConfig.cropLeft;
+    const auto samplePhase = static_cast<unsigned int>(windowColumn % factor);
+    decimator.convert(samples.subspan(begin, end - begin), samplePhase, mPixels + lineOffsets[line] + windowColumn / factor);
+  }
+  column += count;
+}
+
+template <typename T>
+auto FrameDecoder<T>::startLine(SyncLock::HorizontalEdge edge) -> void {
+  switch (edge) {
+    case SyncLock::HorizontalEdge::Rejected:
+      break;
+    case SyncLock::HorizontalEdge::NewLine:
+      rawLine++;
+      if (cropped) {
+        line = rawLine >= mConfig.cropTop && rawLine < mConfig.cropTop + mConfig.height ? rawLine - mConfig.cropTop : -1;
+      } else {
+        line = (line + 1) % mConfig.height;
+      }
+      column = 0;
+      break;
+    case SyncLock::HorizontalEdge::Realign:
+      column = 0;
+      break;
+  }
+  if (edge != SyncLock::HorizontalEdge::Rejected) {
+    startResampledLine();
+  }
+}
+
+// The step follows the learned line period, so the line always spans the same number of pixels
+template <typename T>
+auto FrameDecoder<T>::startResampledLine() -> void {
+  if (resampling) {
+    resampler.startLine(Resampler<T>::getStep(syncLock.getLineLength(), mConfig.linePixels));
+    windowEnd = mConfig.cropLeft + resampler.getWindowLength();
+  }
+}
+
+template <typename T>
+auto FrameDecoder<T>::startFrame() -> void {
+  position = 0;
+  phase = 0;
+  rawLine = 0;
+  line = mConfig.cropTop > 0 ? -1 : 0;
+  column = 0;
+  startResampledLine();
+}
+
+template class FrameDecoder<Sample>;
+template class FrameDecoder<WideSample>;
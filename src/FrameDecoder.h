@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CompositeSyncSeparator.h"
+#include "DataDispatcher.h"
+#include "Decimator.h"
+#include "PixelConverter.h"
+#include "Resampler.h"
+#include "SyncLock.h"
+#include "TransitionDecoder.h"
+#include "VisualizerConfiguration.h"
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+// Sync and pixel pipeline: turns samples into pixels of a width * height frame, independent of any output.
+// With a crop window, only the lines/columns inside of it are converted; the remaining samples are skipped in bulk.
+// With --line-pixels, each line is resampled from its recovered period (see Resampler) instead of being decimated.
+// With composite sync, the horizontal sync channel carries both syncs and they are separated per run.
+// T is the sample type (Sample or WideSample).
+template <typename T>
+class FrameDecoder final {
+public:
+  // Called on every vertical sync, before the first sample of the new frame is written.
+  // The callback may exchange the target frame using setTarget().
+  using FrameCompletedCallback = std::function<void()>;
+
+  FrameDecoder(
+    const VisualizerConfiguration& config,
+    FrameCompletedCallback frameCompletedCallback = FrameCompletedCallback()
+  );
+
+  // Set frame buffer (width * height pixels) to write to
+  auto setTarget(Pixel* pixels) -> void;
+
+  auto decode(std::span<T> samples) -> void;
+
+  // Restart decoding in the middle of a stream; previousSample is the sample right before the next decoded one.
+  auto reset(T previousSample) -> void;
+
+  // Number of samples decoded so far (including the ones before the current vertical sync when called from the callback)
+  [[nodiscard]] auto getDecodedSampleCount() const -> uint64_t;
+
+  [[nodiscard]] auto getSyncLock() const -> const SyncLock&;
+
+private:
+  inline auto write(std::span<T> samples) -> void;
+  inline auto writeLocked(std::span<T> samples) -> void;
+  inline auto writeWindow(std::span<T> samples) -> void;
+  inline auto startLine(SyncLock::HorizontalEdge edge) -> void;
+  inline auto startResampledLine() -> void;
+  inline auto startFrame() -> void;
+
+  const VisualizerConfiguration& mConfig;
+  FrameCompletedCallback mFrameCompletedCallback;
+
+  const T vSyncChannelMask = 0;
+  const T hSyncChannelMask = 0;
+  const long int frameSize = 0;
+  TransitionDecoder<T> transitionDecoder;
+  PixelConverter<T> pixelConverter;
+  Decimator<T> decimator;
+  Resampler<T> resampler;
+  SyncLock syncLock; // also learns the line period for resampling without sync lock
+  CompositeSyncSeparator compositeSyncSeparator;
+  std::vector<long int> lineOffsets;
+  const bool resampling = false;
+  const bool cropped = false;   // also with resampling, which needs the line starts
+  long int windowEnd = 0;       // column after the last visible sample (changes with the line period when resampling)
+
+  Pixel* mPixels = nullptr;
+  long int position = 0;
+  unsigned int phase = 0; // samples of the current pixel already written at position (decimation)
+  // used instead of position with sync lock or cropping
+  long int rawLine = 0; // lines since the vertical sync
+  long int line = 0;    // target line, -1 when outside of the crop window
+  long int column = 0;  // samples since the start of the line
+  uint64_t decodedSampleCount = 0;
+  bool previousSampleVSyncActive = false;
+  bool previousSampleHSyncActive = false;
+};
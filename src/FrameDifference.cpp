@@ -0,0 +1,39 @@
+#include "FrameDifference.h"
+#include <algorithm>
+#include <cstring>
+
+FrameDifference::FrameDifference(int width, int height)
+  : mWidth(width),
+    mHeight(height),
+    tileColumns((width + TILE_SIZE - 1) / TILE_SIZE),
+    previousFrame(static_cast<size_t>(width) * height),
+    dirtyTiles(static_cast<size_t>(tileColumns) * ((height + TILE_SIZE - 1) / TILE_SIZE), 1) {
+}
+
+auto FrameDifference::update(std::span<const Pixel> frame) -> size_t {
+  if (first) {
+    std::copy_n(frame.begin(), std::min(frame.size(), previousFrame.size()), previousFrame.begin());
+    first = false;
+    return dirtyTiles.size();
+  }
+
+  std::fill(dirtyTiles.begin(), dirtyTiles.end(), 0);
+  size_t changed = 0;
+  for (int y = 0; y < mHeight; y++) {
+    auto* dirtyRow = dirtyTiles.data() + static_cast<size_t>(y / TILE_SIZE) * tileColumns;
+    for (int tile = 0; tile < tileColumns; tile++) {
+      const auto offset = static_cast<size_t>(y) * mWidth + static_cast<size_t>(tile) * TILE_SIZE;
+      const auto bytes = static_cast<size_t>(std::min(TILE_SIZE, mWidth - tile * TILE_SIZE)) * sizeof(Pixel);
+      if (!dirtyRow[tile]) {
+        if (std::memcmp(frame.data() + offset, previousFrame.data() + offset, bytes) == 0) {
+          continue;
+        }
+        dirtyRow[tile] = 1;
+        changed++;
+      }
+      std::memcpy(previousFrame.data() + offset, frame.data() + offset, bytes);
+    }
+  }
+
+  return changed;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "SdlWrapper.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Detects which tiles of a frame changed since the previous one, so unchanged frames can be skipped and only the
+// changed tiles need to be uploaded or sent. A copy of the previous frame is kept; every line segment of a tile is
+// compared until the tile turns out to be dirty, then the remaining segments are only copied.
+class FrameDifference final {
+public:
+  static constexpr int TILE_SIZE = 32; // pixels (width and height)
+
+  FrameDifference(int width, int height);
+
+  // Compare with the previous frame (the first frame is completely dirty) and keep the frame for the next comparison.
+  // Returns the number of changed tiles.
+  auto update(std::span<const Pixel> frame) -> size_t;
+
+  // One entry per tile (row by row), non-zero when the tile changed in the last update()
+  [[nodiscard]] auto getDirtyTiles() const -> std::span<const uint8_t> {
+    return dirtyTiles;
+  }
+
+  [[nodiscard]] auto getTileColumns() const -> int {
+    return tileColumns;
+  }
+
+  [[nodiscard]] auto getTileCount() const -> size_t {
+    return dirtyTiles.size();
+  }
+
+private:
+  const int mWidth;
+  const int mHeight;
+  const int tileColumns;
+  std::vector<Pixel> previousFrame;
+  std::vector<uint8_t> dirtyTiles;
+  bool first = true;
+};
@@ -0,0 +1,49 @@
+#include "FrameExchange.h"
+#include <algorithm>
+
+FrameExchange::FrameExchange(size_t pixelCount, size_t tileCount) : pendingDirtyTiles(tileCount, 0) {
+  for (auto& buffer : buffers) {
+    buffer.resize(pixelCount, 0);
+  }
+  for (auto& dirtyTiles : bufferDirtyTiles) {
+    dirtyTiles.resize(tileCount, 0);
+  }
+}
+
+auto FrameExchange::publish(std::span<const Pixel> frame, std::span<const uint8_t> dirtyTiles) -> void {
+  auto& buffer = buffers[backIndex];
+  std::copy_n(frame.begin(), std::min(frame.size(), buffer.size()), buffer.begin());
+
+  // When the previous frame is still unpresented it may get dropped, so its tiles stay dirty. The presenter might
+  // acquire it in the meantime, which only results in uploading some tiles again.
+  const bool previousAcquired = !(middle.load(std::memory_order_acquire) & FRESH);
+  for (size_t i = 0; i < pendingDirtyTiles.size() && i < dirtyTiles.size(); i++) {
+    pendingDirtyTiles[i] = previousAcquired ? dirtyTiles[i] : static_cast<uint8_t>(pendingDirtyTiles[i] | dirtyTiles[i]);
+  }
+  bufferDirtyTiles[backIndex] = pendingDirtyTiles;
+
+  const auto previous = middle.exchange(static_cast<uint8_t>(backIndex | FRESH), std::memory_order_acq_rel);
+  if (previous & FRESH) {
+    droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  backIndex = previous & INDEX_MASK;
+  publishedFrameCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto FrameExchange::acquire() -> std::optional<ExchangedFrame> {
+  if (!(middle.load(std::memory_order_acquire) & FRESH)) {
+    return std::optional<ExchangedFrame>();
+  }
+  const auto previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+  frontIndex = previous & INDEX_MASK;
+
+  return ExchangedFrame{buffers[frontIndex], bufferDirtyTiles[frontIndex]};
+}
+
+auto FrameExchange::getPublishedFrameCount() const -> uint64_t {
+  return publishedFrameCount.load(std::memory_order_relaxed);
+}
+
+auto FrameExchange::getDroppedFrameCount() const -> uint64_t {
+  return droppedFrameCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SdlWrapper.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Frame handed to the presenter together with the tiles that changed since the previously acquired frame
+struct ExchangedFrame {
+  std::span<const Pixel> pixels;
+  std::span<const uint8_t> dirtyTiles; // see FrameDifference
+};
+
+// Lock-free triple buffer for handing complete frames from the decoder to the presenter.
+// The decoder never waits: when the presenter is too slow, the older unpresented frame is replaced (dropped).
+// The dirty tiles of dropped frames are carried over to the next one.
+class FrameExchange final {
+public:
+  FrameExchange(size_t pixelCount, size_t tileCount);
+
+  // To be called by decoder:
+  // Copy frame into the back buffer and make it the newest frame.
+  auto publish(std::span<const Pixel> frame, std::span<const uint8_t> dirtyTiles) -> void;
+
+  // To be called by presenter:
+  // Newest frame if a new one has been published since the last call.
+  // The returned spans stay valid until the next call.
+  auto acquire() -> std::optional<ExchangedFrame>;
+
+  [[nodiscard]] auto getPublishedFrameCount() const -> uint64_t;
+  [[nodiscard]] auto getDroppedFrameCount() const -> uint64_t;
+
+private:
+  std::array<std::vector<Pixel>, 3> buffers;
+  std::array<std::vector<uint8_t>, 3> bufferDirtyTiles;
+  std::vector<uint8_t> pendingDirtyTiles; // owned by decoder: changes since the last frame the presenter acquired
+  uint8_t backIndex = 0;  // owned by decoder
+  uint8_t frontIndex = 1; // owned by presenter
+  std::atomic<uint8_t> middle = 2; // buffer index | FRESH
+  std::atomic<uint64_t> publishedFrameCount = 0;
+  std::atomic<uint64_t> droppedFrameCount = 0;
+
+  static constexpr uint8_t FRESH = 0x04;
+  static constexpr uint8_t INDEX_MASK = 0x03;
+};
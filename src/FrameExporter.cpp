@@ -0,0 +1,83 @@
+#include "FrameExporter.h"
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <span>
+
+template <typename T>
+FrameExporter<T>::FrameExporter(
+  DataDispatcher<T>& dataDispatcher,
+  const VisualizerConfiguration& config,
+  Statistics* statistics
+) : mDataDispatcher(dataDispatcher),
+    mConfig(config),
+    mStatistics(statistics),
+    frame(static_cast<size_t>(mConfig.width) * mConfig.height),
+    frameWriter(mConfig.outputPath, mConfig.width, mConfig.height),
+    frameDifference(mConfig.width, mConfig.height),
+    frameDecoder(mConfig, [this]() { frameCompleted(); }) {
+  frameDecoder.setTarget(frame.data());
+  if (mConfig.persistence != Persistence::Off) {
+    frameAccumulator.emplace(frame.size(), mConfig.persistence, mConfig.persistenceFrames);
+  }
+}
+
+template <typename T>
+auto FrameExporter<T>::run() -> void {
+  while (true) {
+    auto optionalData = mDataDispatcher.get(std::chrono::milliseconds(250));
+    if (optionalData) {
+      {
+        ScopedTimer timer(mStatistics, &Statistics::decodeNanoseconds);
+        frameDecoder.decode(optionalData.value());
+      }
+      if (mStatistics) {
+        mStatistics->decodedSampleCount.fetch_add(optionalData->size(), std::memory_order_relaxed);
+      }
+      mDataDispatcher.clear();
+    } else if (mDataDispatcher.isClosed()) {
+      break;
+    }
+  }
+
+  if (mConfig.syncLock) {
+    std::cerr << frameDecoder.getSyncLock().getSummary() << std::endl;
+  }
+}
+
+// The samples before the first vertical sync don't form a complete frame and are not written.
+template <typename T>
+auto FrameExporter<T>::frameCompleted() -> void {
+  if (mStatistics) {
+    mStatistics->decodedFrameCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (frameStarted) {
+    std::span<const Pixel> writtenFrame = frame;
+    if (frameAccumulator) {
+      ScopedTimer timer(mStatistics, &Statistics::accumulateNanoseconds);
+      writtenFrame = frameAccumulator->accumulate(frame);
+    }
+    if (mConfig.skipUnchangedFrames || mStatistics) {
+      const auto changedTiles = frameDifference.update(writtenFrame);
+      if (mStatistics) {
+        mStatistics->comparedTileCount.fetch_add(frameDifference.getTileCount(), std::memory_order_relaxed);
+        mStatistics->changedTileCount.fetch_add(changedTiles, std::memory_order_relaxed);
+      }
+      if (mConfig.skipUnchangedFrames && changedTiles == 0) {
+        frameWriter.skip();
+        if (mStatistics) {
+          mStatistics->unchangedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+      }
+    }
+    frameWriter.write(writtenFrame);
+    if (mStatistics) {
+      mStatistics->presentedFrameCount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  frameStarted = true;
+}
+
+template class FrameExporter<Sample>;
+template class FrameExporter<WideSample>;
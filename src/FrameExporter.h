@@ -0,0 +1,41 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "FrameAccumulator.h"
+#include "FrameDecoder.h"
+#include "FrameDifference.h"
+#include "FrameWriter.h"
+#include "Statistics.h"
+#include "VisualizerConfiguration.h"
+#include <optional>
+#include <vector>
+
+// Headless counterpart of DataVisualizer: decodes as fast as possible and writes every completed frame to disk
+// (optionally leaving out frames that are identical to the previous one). With persistence, the accumulated image is
+// written instead.
+template <typename T>
+class FrameExporter final {
+public:
+  FrameExporter(
+    DataDispatcher<T>& dataDispatcher,
+    const VisualizerConfiguration& config,
+    Statistics* statistics = nullptr
+  );
+
+  // Main loop: Fetches new samples until the data source closes the channel.
+  auto run() -> void;
+
+private:
+  inline auto frameCompleted() -> void;
+
+  DataDispatcher<T>& mDataDispatcher;
+  const VisualizerConfiguration& mConfig;
+  Statistics* mStatistics;
+
+  std::vector<Pixel> frame;
+  std::optional<FrameAccumulator> frameAccumulator;
+  FrameWriter frameWriter;
+  FrameDifference frameDifference;
+  FrameDecoder<T> frameDecoder;
+  bool frameStarted = false;
+};
@@ -0,0 +1,142 @@
+#include "FrameIndex.h"
+#include "FrameIndexer.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+template <typename T>
+FrameIndex<T>::FrameIndex(
+  std::span<const T> samples,
+  uint8_t vSyncChannel,
+  bool invertVSync,
+  const std::string& capturePath,
+  const NativeCapture* nativeCapture
+) : mSamples(samples),
+    mVSyncChannel(vSyncChannel),
+    mInvertVSync(invertVSync),
+    sidecarPath(capturePath + ".vgi") {
+  if (nativeCapture) {
+    const auto& header = nativeCapture->getHeader();
+    const auto frameIndex = nativeCapture->getFrameIndex();
+    if (header.frameIndexVSyncChannel == mVSyncChannel && static_cast<bool>(header.frameIndexVSyncInverted) == mInvertVSync && isValid(frameIndex)) {
+      frameStarts.assign(frameIndex.begin(), frameIndex.end());
+      complete.store(true);
+      return;
+    }
+  }
+  if (load()) {
+    complete.store(true);
+    return;
+  }
+
+  indexerThread = std::thread([this]() { build(); });
+}
+
+template <typename T>
+FrameIndex<T>::~FrameIndex() {
+  stopRequested.store(true);
+  if (indexerThread.joinable()) {
+    indexerThread.join();
+  }
+}
+
+template <typename T>
+auto FrameIndex<T>::isComplete() const -> bool {
+  return complete.load();
+}
+
+template <typename T>
+auto FrameIndex<T>::getFrameCount() const -> size_t {
+  std::lock_guard lock(mutex);
+  return frameStarts.size();
+}
+
+template <typename T>
+auto FrameIndex<T>::getFrameStart(size_t frame) const -> std::optional<uint64_t> {
+  std::lock_guard lock(mutex);
+  return frame < frameStarts.size() ? std::optional<uint64_t>(frameStarts[frame]) : std::optional<uint64_t>();
+}
+
+template <typename T>
+auto FrameIndex<T>::findFrame(uint64_t position) const -> size_t {
+  std::lock_guard lock(mutex);
+  const auto next = std::upper_bound(frameStarts.begin(), frameStarts.end(), position);
+  return next == frameStarts.begin() ? 0 : static_cast<size_t>(next - frameStarts.begin() - 1);
+}
+
+// Indexer thread: scans the capture chunk by chunk, so seeking into the beginning works early on.
+template <typename T>
+auto FrameIndex<T>::build() -> void {
+  FrameIndexer<T> indexer(mVSyncChannel, mInvertVSync);
+  size_t published = 0;
+  for (size_t offset = 0; offset < mSamples.size(); offset += CHUNK_SIZE) {
+    if (stopRequested.load()) {
+      return; // incomplete, not saved
+    }
+    indexer.scan(mSamples.subspan(offset, std::min(CHUNK_SIZE, mSamples.size() - offset)));
+    const auto& found = indexer.getFrameStarts();
+    std::lock_guard lock(mutex);
+    frameStarts.insert(frameStarts.end(), found.begin() + static_cast<std::ptrdiff_t>(published), found.end());
+    published = found.size();
+  }
+  complete.store(true);
+  save();
+}
+
+template <typename T>
+auto FrameIndex<T>::load() -> bool {
+  std::ifstream file(sidecarPath, std::ios::binary);
+  FrameIndexFileHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    return false;
+  }
+  if (header.magic != FrameIndexFileHeader::MAGIC || header.version != FrameIndexFileHeader::VERSION || header.vSyncChannel != mVSyncChannel || static_cast<bool>(header.vSyncInverted) != mInvertVSync || header.sampleCount != mSamples.size()) {
+    return false; // stale or for other settings, will be rebuilt
+  }
+  // A corrupt file must neither make the allocation fail nor let playback read outside the capture
+  file.seekg(0, std::ios::end);
+  const auto fileSize = static_cast<uint64_t>(file.tellg());
+  if (header.frameCount > header.sampleCount || fileSize != sizeof(header) + header.frameCount * sizeof(uint64_t)) {
+    return false;
+  }
+  file.seekg(sizeof(header));
+  std::vector<uint64_t> loaded(header.frameCount);
+  if (!file.read(reinterpret_cast<char*>(loaded.data()), static_cast<std::streamsize>(loaded.size() * sizeof(uint64_t))) || !isValid(loaded)) {
+    return false;
+  }
+  frameStarts = std::move(loaded);
+
+  return true;
+}
+
+// Frame starts must be strictly increasing offsets within the capture
+template <typename T>
+auto FrameIndex<T>::isValid(std::span<const uint64_t> loadedFrameStarts) const -> bool {
+  for (size_t i = 0; i < loadedFrameStarts.size(); i++) {
+    if (loadedFrameStarts[i] >= mSamples.size() || (i > 0 && loadedFrameStarts[i] <= loadedFrameStarts[i - 1])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// A missing sidecar file only costs rebuilding the index, so failing to write it (e.g. read-only media) is no error.
+template <typename T>
+auto FrameIndex<T>::save() const -> void {
+  FrameIndexFileHeader header;
+  header.vSyncChannel = mVSyncChannel;
+  header.vSyncInverted = mInvertVSync ? 1 : 0;
+  header.sampleCount = mSamples.size();
+  std::lock_guard lock(mutex);
+  header.frameCount = frameStarts.size();
+  std::ofstream file(sidecarPath, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(frameStarts.data()), static_cast<std::streamsize>(frameStarts.size() * sizeof(uint64_t)));
+  if (!file) {
+    std::cerr << "Warning: Unable to write frame index " << sidecarPath << "." << std::endl;
+  }
+}
+
+template class FrameIndex<Sample>;
+template class FrameIndex<WideSample>;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "NativeCapture.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sidecar file of a recorded session ("<capture>.vgi") holding its frame index (host byte order):
+//   FrameIndexFileHeader
+//   frameCount * uint64_t sample offsets of vertical syncs
+struct FrameIndexFileHeader {
+  static constexpr std::array<char, 8> MAGIC = {'V', 'I', 'D', 'G', 'R', 'O', 'K', 'I'};
+  static constexpr uint32_t VERSION = 1;
+
+  std::array<char, 8> magic = MAGIC;
+  uint32_t version = VERSION;
+  uint8_t vSyncChannel = 0; // channel the index was built from
+  uint8_t vSyncInverted = 0;
+  uint8_t reserved[2] = {};
+  uint64_t sampleCount = 0; // of the capture, a changed capture invalidates the index
+  uint64_t frameCount = 0;
+};
+
+// Sample offsets of all frame starts of a recorded capture (where vertical sync ends, like in FrameDecoder) for
+// seeking. Taken from a native capture or the sidecar file when built for the same vertical sync settings (and valid
+// for the capture), otherwise built on a background thread while the capture is already playing and saved to the
+// sidecar file when complete.
+template <typename T>
+class FrameIndex final {
+public:
+  FrameIndex(
+    std::span<const T> samples,
+    uint8_t vSyncChannel,
+    bool invertVSync,
+    const std::string& capturePath,
+    const NativeCapture* nativeCapture = nullptr
+  );
+  ~FrameIndex();
+  FrameIndex(const FrameIndex&) = delete;
+  auto operator=(const FrameIndex&) -> FrameIndex& = delete;
+
+  // All frames are known
+  [[nodiscard]] auto isComplete() const -> bool;
+  // Frames known so far
+  [[nodiscard]] auto getFrameCount() const -> size_t;
+  [[nodiscard]] auto getFrameStart(size_t frame) const -> std::optional<uint64_t>;
+  // Frame the sample offset belongs to (0 before the first frame start)
+  [[nodiscard]] auto findFrame(uint64_t position) const -> size_t;
+
+private:
+  auto build() -> void;
+  auto load() -> bool;
+  [[nodiscard]] auto isValid(std::span<const uint64_t> loadedFrameStarts) const -> bool;
+  auto save() const -> void;
+
+  const std::span<const T> mSamples;
+  const uint8_t mVSyncChannel;
+  const bool mInvertVSync;
+  const std::string sidecarPath;
+
+  mutable std::mutex mutex;
+  std::vector<uint64_t> frameStarts;
+  std::atomic<bool> complete = false;
+  std::atomic<bool> stopRequested = false;
+  std::thread indexerThread;
+
+  static constexpr size_t CHUNK_SIZE = 16 * 1024 * 1024; // samples scanned before the new frames are published
+};
@@ -0,0 +1,70 @@
+#include "FrameIndexer.h"
+#include <algorithm>
+#include <thread>
+
+template <typename T>
+FrameIndexer<T>::FrameIndexer(
+  uint8_t vSyncChannel,
+  bool invertVSync
+) : vSyncChannelMask(static_cast<T>(1 << vSyncChannel)),
+    mInvertVSync(invertVSync),
+    transitionDecoder(vSyncChannelMask) {
+}
+
+template <typename T>
+auto FrameIndexer<T>::seek(uint64_t offset, T previousSample) -> void {
+  position = offset;
+  previousSampleVSyncActive = mInvertVSync == static_cast<bool>(previousSample & vSyncChannelMask);
+}
+
+template <typename T>
+auto FrameIndexer<T>::scan(std::span<const T> samples) -> void {
+  for (const auto& run : transitionDecoder.decode(samples)) {
+    const bool vSyncActive = mInvertVSync == static_cast<bool>(run.value & vSyncChannelMask);
+    if (previousSampleVSyncActive && !vSyncActive) {
+      frameStarts.push_back(position);
+    }
+    previousSampleVSyncActive = vSyncActive;
+    position += run.length;
+  }
+}
+
+template <typename T>
+auto FrameIndexer<T>::getFrameStarts() const -> const std::vector<uint64_t>& {
+  return frameStarts;
+}
+
+template <typename T>
+auto FrameIndexer<T>::findFrameStarts(
+  std::span<const T> samples,
+  uint8_t vSyncChannel,
+  bool invertVSync,
+  unsigned int threadCount
+) -> std::vector<uint64_t> {
+  threadCount = std::max(1U, threadCount);
+  const size_t chunkSize = (samples.size() + threadCount - 1) / threadCount;
+  std::vector<FrameIndexer> indexers(threadCount, FrameIndexer(vSyncChannel, invertVSync));
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < threadCount; i++) {
+    const size_t start = std::min(samples.size(), i * chunkSize);
+    const size_t end = std::min(samples.size(), start + chunkSize);
+    threads.emplace_back([&indexers, samples, i, start, end]() {
+      if (start > 0) {
+        indexers[i].seek(start, samples[start - 1]);
+      }
+      indexers[i].scan(samples.subspan(start, end - start));
+    });
+  }
+
+  std::vector<uint64_t> frameStarts;
+  for (unsigned int i = 0; i < threadCount; i++) {
+    threads[i].join();
+    const auto& chunkFrameStarts = indexers[i].getFrameStarts();
+    frameStarts.insert(frameStarts.end(), chunkFrameStarts.begin(), chunkFrameStarts.end());
+  }
+
+  return frameStarts;
+}
+
+template class FrameIndexer<Sample>;
+template class FrameIndexer<WideSample>;
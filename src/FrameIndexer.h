@@ -0,0 +1,33 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "TransitionDecoder.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Collects the sample offsets where vertical sync ends (= start of a frame, like in FrameDecoder).
+template <typename T>
+class FrameIndexer final {
+public:
+  FrameIndexer(uint8_t vSyncChannel, bool invertVSync);
+
+  // Continue scanning at the given stream offset; previousSample is the sample right before it.
+  auto seek(uint64_t offset, T previousSample) -> void;
+
+  // Scan next block of the stream
+  auto scan(std::span<const T> samples) -> void;
+
+  [[nodiscard]] auto getFrameStarts() const -> const std::vector<uint64_t>&;
+
+  // Scan a complete capture, split into chunks that are scanned in parallel
+  [[nodiscard]] static auto findFrameStarts(std::span<const T> samples, uint8_t vSyncChannel, bool invertVSync, unsigned int threadCount) -> std::vector<uint64_t>;
+
+private:
+  const T vSyncChannelMask;
+  const bool mInvertVSync;
+  TransitionDecoder<T> transitionDecoder;
+  std::vector<uint64_t> frameStarts;
+  uint64_t position = 0;
+  bool previousSampleVSyncActive = false;
+};
@@ -0,0 +1,196 @@
+#include "FrameServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+template <typename T>
+FrameServer<T>::FrameServer(
+  std::unique_ptr<StreamDecoder<T>> streamDecoder,
+  const VisualizerConfiguration& config,
+  const std::string& address,
+  Statistics* statistics
+) : mStreamDecoder(std::move(streamDecoder)),
+    mConfig(config),
+    mAddress(address),
+    mStatistics(statistics),
+    listeningSocket(listenOnFrameStream(address)),
+    frameCodec(mConfig.width, mConfig.height),
+    previousFrame(static_cast<size_t>(mConfig.width) * mConfig.height, 0) {
+}
+
+template <typename T>
+FrameServer<T>::~FrameServer() {
+  for (auto& viewer : viewers) {
+    disconnect(viewer);
+  }
+  close(listeningSocket);
+  if (mAddress.find('/') != std::string::npos) {
+    unlink(mAddress.c_str());
+  }
+}
+
+template <typename T>
+auto FrameServer<T>::run() -> void {
+  std::cerr << "Serving frames on " << mAddress << "." << std::endl;
+  mStreamDecoder->start();
+
+  try {
+    std::optional<std::chrono::time_point<std::chrono::steady_clock>> finishedAt;
+    while (true) {
+      const bool finished = mStreamDecoder->isFinished();
+      acceptViewers();
+      const auto frame = mStreamDecoder->acquire();
+      if (frame) {
+        serve(frame.value());
+      }
+      for (auto& viewer : viewers) {
+        if (!send(viewer)) {
+          disconnect(viewer);
+        }
+      }
+      std::erase_if(viewers, [](const Viewer& viewer) { return viewer.socket < 0; });
+
+      // At the end of the stream, the viewers get some time to receive the last frames
+      if (finished && !frame) {
+        finishedAt = finishedAt.value_or(std::chrono::steady_clock::now());
+        const bool sent = std::all_of(viewers.begin(), viewers.end(), [](const Viewer& viewer) { return viewer.queue.empty(); });
+        if (sent || std::chrono::steady_clock::now() >= finishedAt.value() + FINISH_TIMEOUT) {
+          break;
+        }
+      }
+
+      waitForSockets();
+    }
+  } catch (...) {
+    mStreamDecoder->stop();
+    mStreamDecoder->join();
+    throw;
+  }
+
+  mStreamDecoder->stop();
+  mStreamDecoder->join();
+  for (auto& viewer : viewers) {
+    disconnect(viewer); // end of stream
+  }
+  viewers.clear();
+}
+
+// New viewers get the stream header and the current frame right away (the next frame might only come with a change).
+template <typename T>
+auto FrameServer<T>::acceptViewers() -> void {
+  while (true) {
+    const int socket = accept(listeningSocket, nullptr, nullptr);
+    if (socket < 0) {
+      break;
+    }
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+
+    Viewer viewer;
+    viewer.socket = socket;
+    FrameStreamHeader header;
+    header.width = static_cast<uint32_t>(mConfig.width);
+    header.height = static_cast<uint32_t>(mConfig.height);
+    const auto* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    viewer.queue.push_back(std::make_shared<const std::vector<uint8_t>>(headerBytes, headerBytes + sizeof(header)));
+    if (frameNumber > 0) {
+      viewer.queue.push_back(std::make_shared<const std::vector<uint8_t>>(frameCodec.encodeKeyframe(previousFrame, frameNumber)));
+      viewer.needsKeyframe = false;
+    }
+    viewers.push_back(std::move(viewer));
+  }
+}
+
+// Each message is only encoded when a viewer needs it, and only once.
+template <typename T>
+auto FrameServer<T>::serve(const ExchangedFrame& frame) -> void {
+  frameNumber++;
+  Message keyframe;
+  Message delta;
+  for (auto& viewer : viewers) {
+    if (viewer.queue.size() >= MAX_QUEUED_FRAMES) {
+      // Too slow: drop the frames not started yet, the next delta would be based on a missing frame
+      viewer.queue.erase(viewer.queue.begin() + (viewer.sentBytes > 0 ? 1 : 0), viewer.queue.end());
+      viewer.needsKeyframe = true;
+    }
+    if (viewer.needsKeyframe) {
+      if (!keyframe) {
+        keyframe = std::make_shared<const std::vector<uint8_t>>(frameCodec.encodeKeyframe(frame.pixels, frameNumber));
+      }
+      viewer.queue.push_back(keyframe);
+      viewer.needsKeyframe = false;
+    } else {
+      if (!delta) {
+        delta = std::make_shared<const std::vector<uint8_t>>(frameCodec.encodeDelta(frame.pixels, previousFrame, frame.dirtyTiles, frameNumber));
+      }
+      viewer.queue.push_back(delta);
+    }
+  }
+  std::copy_n(frame.pixels.begin(), std::min(frame.pixels.size(), previousFrame.size()), previousFrame.begin());
+  if (mStatistics) {
+    mStatistics->presentedFrameCount.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+// Send as much as the socket takes without blocking. Returns false when the viewer is gone.
+template <typename T>
+auto FrameServer<T>::send(Viewer& viewer) -> bool {
+  while (!viewer.queue.empty()) {
+    const auto& message = *viewer.queue.front();
+    const auto result = ::send(viewer.socket, message.data() + viewer.sentBytes, message.size() - viewer.sentBytes, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (result < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    viewer.sentBytes += static_cast<size_t>(result);
+    if (viewer.sentBytes == message.size()) {
+      viewer.queue.pop_front();
+      viewer.sentBytes = 0;
+    }
+  }
+
+  return true;
+}
+
+// Wait until a viewer connects, can take more data or has left (viewers don't send anything), at most a poll interval
+// so new frames are picked up.
+template <typename T>
+auto FrameServer<T>::waitForSockets() -> void {
+  std::vector<pollfd> descriptors;
+  descriptors.push_back({listeningSocket, POLLIN, 0});
+  for (const auto& viewer : viewers) {
+    descriptors.push_back({viewer.socket, static_cast<short>(POLLIN | (viewer.queue.empty() ? 0 : POLLOUT)), 0});
+  }
+  if (poll(descriptors.data(), descriptors.size(), static_cast<int>(POLL_INTERVAL.count())) <= 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < viewers.size(); i++) {
+    const auto events = descriptors[i + 1].revents;
+    if (events & (POLLERR | POLLHUP)) {
+      disconnect(viewers[i]);
+    } else if (events & POLLIN) {
+      uint8_t ignored[256];
+      const auto result = recv(viewers[i].socket, ignored, sizeof(ignored), MSG_DONTWAIT);
+      if (result == 0 || (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        disconnect(viewers[i]);
+      }
+    }
+  }
+  std::erase_if(viewers, [](const Viewer& viewer) { return viewer.socket < 0; });
+}
+
+template <typename T>
+auto FrameServer<T>::disconnect(Viewer& viewer) -> void {
+  if (viewer.socket >= 0) {
+    close(viewer.socket);
+    viewer.socket = -1;
+  }
+  viewer.queue.clear();
+}
+
+template class FrameServer<Sample>;
+template class FrameServer<WideSample>;
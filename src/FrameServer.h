@@ -0,0 +1,66 @@
+#pragma once
+
+#include "FrameStream.h"
+#include "Statistics.h"
+#include "StreamDecoder.h"
+#include "VisualizerConfiguration.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Window-less counterpart of DataVisualizer for headless hosts: publishes the frames of a stream to any number of
+// viewers (see FrameViewer) over a socket, as keyframes and run-length-encoded deltas of the changed tiles.
+// Each frame is encoded once and shared by all viewers. Sockets are non-blocking: a viewer that can't keep up skips
+// frames and continues with a keyframe, so neither the decoder nor the other viewers are slowed down.
+template <typename T>
+class FrameServer final {
+public:
+  FrameServer(
+    std::unique_ptr<StreamDecoder<T>> streamDecoder,
+    const VisualizerConfiguration& config,
+    const std::string& address,
+    Statistics* statistics = nullptr
+  );
+  ~FrameServer();
+  FrameServer(const FrameServer&) = delete;
+  auto operator=(const FrameServer&) -> FrameServer& = delete;
+
+  // Main loop: Serves frames until the stream has ended.
+  auto run() -> void;
+
+private:
+  using Message = std::shared_ptr<const std::vector<uint8_t>>;
+
+  struct Viewer {
+    int socket = -1;
+    std::deque<Message> queue; // front is being sent
+    size_t sentBytes = 0;      // of the front message
+    bool needsKeyframe = true;
+  };
+
+  auto acceptViewers() -> void;
+  auto serve(const ExchangedFrame& frame) -> void;
+  auto send(Viewer& viewer) -> bool;
+  auto waitForSockets() -> void;
+  auto disconnect(Viewer& viewer) -> void;
+
+  std::unique_ptr<StreamDecoder<T>> mStreamDecoder;
+  const VisualizerConfiguration& mConfig;
+  const std::string mAddress;
+  Statistics* mStatistics;
+
+  int listeningSocket;
+  std::vector<Viewer> viewers;
+  FrameCodec frameCodec;
+  std::vector<Pixel> previousFrame; // last frame served, base of the deltas
+  uint64_t frameNumber = 0;
+
+  static constexpr size_t MAX_QUEUED_FRAMES = 4; // per viewer, more are dropped
+  const std::chrono::milliseconds POLL_INTERVAL = std::chrono::milliseconds(4);
+  const std::chrono::milliseconds FINISH_TIMEOUT = std::chrono::milliseconds(1000); // for sending the last frames
+};
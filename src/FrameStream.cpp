@@ -0,0 +1,229 @@
+#include "FrameStream.h"
+#include "FrameDifference.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <utility>
+
+FrameCodec::FrameCodec(int width, int height)
+  : mWidth(width),
+    mHeight(height),
+    tileColumns((width + FrameDifference::TILE_SIZE - 1) / FrameDifference::TILE_SIZE) {
+}
+
+auto FrameCodec::encodeKeyframe(std::span<const Pixel> frame, uint64_t frameNumber) -> std::vector<uint8_t> {
+  startMessage(FrameMessageHeader::Type::Keyframe, frameNumber);
+  for (const auto pixel : frame) {
+    add(pixel);
+  }
+
+  return finishMessage();
+}
+
+auto FrameCodec::encodeDelta(
+  std::span<const Pixel> frame,
+  std::span<const Pixel> previousFrame,
+  std::span<const uint8_t> dirtyTiles,
+  uint64_t frameNumber
+) -> std::vector<uint8_t> {
+  constexpr int tileSize = FrameDifference::TILE_SIZE;
+  startMessage(FrameMessageHeader::Type::Delta, frameNumber);
+  for (int y = 0; y < mHeight; y++) {
+    const auto* tiles = dirtyTiles.data() + static_cast<size_t>(y / tileSize) * static_cast<size_t>(tileColumns);
+    const auto row = static_cast<size_t>(y) * static_cast<size_t>(mWidth);
+    for (int column = 0; column < tileColumns; column++) {
+      const int first = column * tileSize;
+      const int last = std::min(first + tileSize, mWidth);
+      if (!tiles[column]) {
+        add(0, static_cast<uint32_t>(last - first));
+        continue;
+      }
+      for (auto i = row + static_cast<size_t>(first); i < row + static_cast<size_t>(last); i++) {
+        add(frame[i] ^ previousFrame[i]);
+      }
+    }
+  }
+
+  return finishMessage();
+}
+
+auto FrameCodec::decode(FrameMessageHeader::Type type, std::span<const uint8_t> payload, std::span<Pixel> frame) -> void {
+  const bool delta = type == FrameMessageHeader::Type::Delta;
+  size_t offset = 0;
+  size_t pixel = 0;
+  auto read = [&payload, &offset]() {
+    if (offset + sizeof(uint32_t) > payload.size()) {
+      throw std::runtime_error("Truncated frame in stream.");
+    }
+    uint32_t value;
+    std::memcpy(&value, payload.data() + offset, sizeof(value));
+    offset += sizeof(value);
+    return value;
+  };
+
+  while (offset < payload.size()) {
+    const auto header = read();
+    const auto count = header & ~LITERAL_RUN;
+    if (count > frame.size() - pixel) {
+      throw std::runtime_error("Frame in stream is larger than announced.");
+    }
+    if (header & LITERAL_RUN) {
+      for (uint32_t i = 0; i < count; i++, pixel++) {
+        const auto value = read();
+        frame[pixel] = delta ? frame[pixel] ^ value : value;
+      }
+    } else {
+      const auto value = read();
+      if (!delta) {
+        std::fill_n(frame.begin() + static_cast<std::ptrdiff_t>(pixel), count, value);
+      } else if (value != 0) {
+        for (uint32_t i = 0; i < count; i++) {
+          frame[pixel + i] ^= value;
+        }
+      }
+      pixel += count;
+    }
+  }
+  if (pixel != frame.size()) {
+    throw std::runtime_error("Frame in stream is smaller than announced.");
+  }
+}
+
+auto FrameCodec::startMessage(FrameMessageHeader::Type type, uint64_t frameNumber) -> void {
+  FrameMessageHeader header;
+  header.type = type;
+  header.frameNumber = frameNumber;
+  message.clear();
+  write(&header, sizeof(header)); // payload size is filled in when finished
+}
+
+auto FrameCodec::finishMessage() -> std::vector<uint8_t> {
+  flushRun();
+  flushLiterals();
+  const auto payloadSize = static_cast<uint32_t>(message.size() - sizeof(FrameMessageHeader));
+  std::memcpy(message.data() + offsetof(FrameMessageHeader, payloadSize), &payloadSize, sizeof(payloadSize));
+
+  return std::exchange(message, std::vector<uint8_t>());
+}
+
+auto FrameCodec::add(Pixel value, uint32_t count) -> void {
+  if (runLength > 0 && value == runValue) {
+    runLength += count;
+    return;
+  }
+  flushRun();
+  runValue = value;
+  runLength = count;
+}
+
+// Runs shorter than 3 pixels are not worth a header of their own and become part of a literal run.
+auto FrameCodec::flushRun() -> void {
+  if (runLength < 3) {
+    literals.insert(literals.end(), runLength, runValue);
+  } else {
+    flushLiterals();
+    write(&runLength, sizeof(runLength));
+    write(&runValue, sizeof(runValue));
+  }
+  runLength = 0;
+}
+
+auto FrameCodec::flushLiterals() -> void {
+  if (literals.empty()) {
+    return;
+  }
+  const auto header = static_cast<uint32_t>(literals.size()) | LITERAL_RUN;
+  write(&header, sizeof(header));
+  write(literals.data(), literals.size() * sizeof(Pixel));
+  literals.clear();
+}
+
+auto FrameCodec::write(const void* data, size_t size) -> void {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  message.insert(message.end(), bytes, bytes + size);
+}
+
+namespace {
+
+struct SocketAddress {
+  sockaddr_storage storage = {};
+  socklen_t length = 0;
+};
+
+auto resolve(const std::string& address) -> SocketAddress {
+  SocketAddress result;
+  if (address.find('/') != std::string::npos) {
+    auto& unixAddress = reinterpret_cast<sockaddr_un&>(result.storage);
+    if (address.size() >= sizeof(unixAddress.sun_path)) {
+      throw std::runtime_error("Socket path " + address + " is too long.");
+    }
+    unixAddress.sun_family = AF_UNIX;
+    std::copy(address.begin(), address.end(), unixAddress.sun_path);
+    result.length = sizeof(sockaddr_un);
+    return result;
+  }
+
+  const auto separator = address.rfind(':');
+  const auto host = separator == std::string::npos ? std::string("127.0.0.1") : address.substr(0, separator);
+  const auto port = separator == std::string::npos ? address : address.substr(separator + 1);
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0 || !addresses) {
+    throw std::runtime_error("Unable to resolve frame stream address " + address + ".");
+  }
+  std::memcpy(&result.storage, addresses->ai_addr, addresses->ai_addrlen);
+  result.length = addresses->ai_addrlen;
+  freeaddrinfo(addresses);
+
+  return result;
+}
+
+auto openSocket(const SocketAddress& socketAddress, const std::string& address) -> int {
+  const int socketDescriptor = socket(socketAddress.storage.ss_family, SOCK_STREAM, 0);
+  if (socketDescriptor < 0) {
+    throw std::runtime_error("Unable to create socket for " + address + ": " + std::strerror(errno));
+  }
+
+  return socketDescriptor;
+}
+
+} // namespace
+
+auto listenOnFrameStream(const std::string& address) -> int {
+  const auto socketAddress = resolve(address);
+  const int socketDescriptor = openSocket(socketAddress, address);
+  if (socketAddress.storage.ss_family == AF_UNIX) {
+    unlink(address.c_str()); // left over from a previous run
+  } else {
+    const int enabled = 1;
+    setsockopt(socketDescriptor, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+  }
+  if (bind(socketDescriptor, reinterpret_cast<const sockaddr*>(&socketAddress.storage), socketAddress.length) != 0 || listen(socketDescriptor, SOMAXCONN) != 0) {
+    const std::string error = std::strerror(errno);
+    close(socketDescriptor);
+    throw std::runtime_error("Unable to listen on " + address + ": " + error);
+  }
+  fcntl(socketDescriptor, F_SETFL, fcntl(socketDescriptor, F_GETFL) | O_NONBLOCK);
+
+  return socketDescriptor;
+}
+
+auto connectToFrameStream(const std::string& address) -> int {
+  const auto socketAddress = resolve(address);
+  const int socketDescriptor = openSocket(socketAddress, address);
+  if (connect(socketDescriptor, reinterpret_cast<const sockaddr*>(&socketAddress.storage), socketAddress.length) != 0) {
+    const std::string error = std::strerror(errno);
+    close(socketDescriptor);
+    throw std::runtime_error("Unable to connect to " + address + ": " + error);
+  }
+
+  return socketDescriptor;
+}
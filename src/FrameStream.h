@@ -0,0 +1,77 @@
+#pragma once
+
+#include "SdlWrapper.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Protocol of the frame stream between FrameServer and FrameViewer (host byte order, like the native capture format):
+//   FrameStreamHeader (once, when a viewer connects)
+//   FrameMessageHeader + payloadSize bytes (per frame)
+// The payload is a sequence of runs covering all pixels of the frame, each starting with a uint32_t:
+//   count | LITERAL_RUN: count pixels follow
+//   count:               one pixel follows, repeated count times
+// Keyframes contain the pixels themselves, deltas the pixels XOR the previous frame (unchanged areas are long runs
+// of 0).
+struct FrameStreamHeader {
+  static constexpr std::array<char, 8> MAGIC = {'V', 'I', 'D', 'G', 'R', 'O', 'K', 'S'};
+  static constexpr uint32_t VERSION = 1;
+
+  std::array<char, 8> magic = MAGIC;
+  uint32_t version = VERSION;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t reserved = 0;
+};
+
+struct FrameMessageHeader {
+  enum class Type : uint32_t {
+    Keyframe = 0,
+    Delta = 1,
+  };
+
+  Type type = Type::Keyframe;
+  uint32_t payloadSize = 0;
+  uint64_t frameNumber = 0;
+};
+
+// Run-length encoding of frames for the stream
+class FrameCodec final {
+public:
+  FrameCodec(int width, int height);
+
+  // Complete message (header and payload) of a frame
+  auto encodeKeyframe(std::span<const Pixel> frame, uint64_t frameNumber) -> std::vector<uint8_t>;
+  // Only the dirty tiles (see FrameDifference) are compared with the previous frame, the others are known to be 0.
+  auto encodeDelta(std::span<const Pixel> frame, std::span<const Pixel> previousFrame, std::span<const uint8_t> dirtyTiles, uint64_t frameNumber) -> std::vector<uint8_t>;
+
+  // Apply a message payload to the frame (width * height pixels) of the viewer
+  static auto decode(FrameMessageHeader::Type type, std::span<const uint8_t> payload, std::span<Pixel> frame) -> void;
+
+  static constexpr uint32_t LITERAL_RUN = 0x80000000;
+
+private:
+  auto startMessage(FrameMessageHeader::Type type, uint64_t frameNumber) -> void;
+  auto finishMessage() -> std::vector<uint8_t>;
+  inline auto add(Pixel value, uint32_t count = 1) -> void;
+  auto flushRun() -> void;
+  auto flushLiterals() -> void;
+  auto write(const void* data, size_t size) -> void;
+
+  const int mWidth;
+  const int mHeight;
+  const int tileColumns;
+  std::vector<uint8_t> message;
+  std::vector<Pixel> literals; // single pixels waiting to be written as one literal run
+  Pixel runValue = 0;
+  uint32_t runLength = 0;
+};
+
+// Addresses are "[host:]port" for TCP (host defaults to 127.0.0.1, so the stream is only reachable locally or through
+// a tunnel) or a path containing a slash for a Unix domain socket.
+// Listening socket (non-blocking)
+auto listenOnFrameStream(const std::string& address) -> int;
+auto connectToFrameStream(const std::string& address) -> int;
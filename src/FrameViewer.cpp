@@ -0,0 +1,131 @@
+#include "FrameViewer.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t MAX_SIZE = 16384; // pixels (width and height)
+
+auto readStreamHeader(int socket) -> FrameStreamHeader {
+  FrameStreamHeader header;
+  if (recv(socket, &header, sizeof(header), MSG_WAITALL) != static_cast<ssize_t>(sizeof(header)) || header.magic != FrameStreamHeader::MAGIC) {
+    close(socket);
+    throw std::runtime_error("Not a vidgrok frame stream.");
+  }
+  if (header.version != FrameStreamHeader::VERSION) {
+    close(socket);
+    throw std::runtime_error("Unsupported frame stream version " + std::to_string(header.version) + ".");
+  }
+  if (header.width < 1 || header.height < 1 || header.width > MAX_SIZE || header.height > MAX_SIZE) {
+    close(socket);
+    throw std::runtime_error("Invalid frame size in stream.");
+  }
+
+  return header;
+}
+
+} // namespace
+
+FrameViewer::FrameViewer(const std::string& address)
+  : socket(connectToFrameStream(address)),
+    header(readStreamHeader(socket)),
+    frame(static_cast<size_t>(header.width) * header.height, 0),
+    frameDifference(static_cast<int>(header.width), static_cast<int>(header.height)),
+    frameExchange(frame.size(), frameDifference.getTileCount()),
+    sdlWrapper(static_cast<int>(header.width), static_cast<int>(header.height), "vidgrok - " + address) {
+}
+
+FrameViewer::~FrameViewer() {
+  shutdown(socket, SHUT_RDWR); // wakes up the receiver
+  if (receiverThread.joinable()) {
+    receiverThread.join();
+  }
+  close(socket);
+}
+
+auto FrameViewer::run() -> void {
+  receiverThread = std::thread([this]() { receive(); });
+
+  const SDL_Rect area = {0, 0, static_cast<int>(header.width), static_cast<int>(header.height)};
+  auto lastRenderedAt = std::chrono::steady_clock::now();
+  while (true) {
+    const auto now = std::chrono::steady_clock::now();
+    const bool finished = receivingFinished.load();
+    const auto newFrame = frameExchange.acquire();
+    if (newFrame) {
+      sdlWrapper.updateTexture(area, newFrame->pixels, newFrame->dirtyTiles, FrameDifference::TILE_SIZE);
+    }
+    // Re-render without new frame from time to time to keep the window content intact
+    if (newFrame || now >= lastRenderedAt + WINDOW_REFRESH_INTERVAL) {
+      sdlWrapper.render();
+      lastRenderedAt = now;
+    }
+    if (finished && !newFrame) {
+      break;
+    }
+    if (sdlWrapper.pollEvents().quit) {
+      break;
+    }
+    std::this_thread::sleep_for(PRESENTER_POLL_INTERVAL);
+  }
+
+  // The last frame stays visible until the window is closed
+  if (receivingFinished.load() && !receiverException) {
+    while (!sdlWrapper.pollEvents().quit) {
+      sdlWrapper.render();
+      std::this_thread::sleep_for(WINDOW_REFRESH_INTERVAL);
+    }
+  }
+
+  shutdown(socket, SHUT_RDWR);
+  receiverThread.join();
+  if (receiverException) {
+    std::rethrow_exception(receiverException);
+  }
+}
+
+// Receiver thread: Applies the messages to the frame and hands it to the window.
+auto FrameViewer::receive() -> void {
+  try {
+    FrameMessageHeader messageHeader;
+    while (readExactly(&messageHeader, sizeof(messageHeader))) {
+      if (messageHeader.payloadSize > (frame.size() + 1) * 2 * sizeof(Pixel)) {
+        throw std::runtime_error("Invalid frame size in stream.");
+      }
+      payload.resize(messageHeader.payloadSize);
+      if (!readExactly(payload.data(), payload.size())) {
+        break;
+      }
+      FrameCodec::decode(messageHeader.type, payload, frame);
+      if (frameDifference.update(frame) > 0) {
+        frameExchange.publish(frame, frameDifference.getDirtyTiles());
+      }
+    }
+  } catch (...) {
+    receiverException = std::current_exception();
+  }
+  receivingFinished.store(true);
+}
+
+// Returns false when the stream has ended.
+auto FrameViewer::readExactly(void* data, size_t size) -> bool {
+  auto* bytes = static_cast<uint8_t*>(data);
+  while (size > 0) {
+    const auto result = recv(socket, bytes, size, MSG_WAITALL);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    bytes += result;
+    size -= static_cast<size_t>(result);
+  }
+
+  return true;
+}
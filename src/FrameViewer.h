@@ -0,0 +1,43 @@
+#pragma once
+
+#include "FrameDifference.h"
+#include "FrameExchange.h"
+#include "FrameStream.h"
+#include "SdlWrapper.h"
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Shows the frames published by a FrameServer in an SDL window. The stream is received and decoded on its own thread,
+// the window only uploads the tiles that changed (like DataVisualizer).
+class FrameViewer final {
+public:
+  explicit FrameViewer(const std::string& address);
+  ~FrameViewer();
+  FrameViewer(const FrameViewer&) = delete;
+  auto operator=(const FrameViewer&) -> FrameViewer& = delete;
+
+  // Main loop: Presents frames until the window is closed or the server ends the stream.
+  auto run() -> void;
+
+private:
+  auto receive() -> void;
+  auto readExactly(void* data, size_t size) -> bool;
+
+  const int socket;
+  const FrameStreamHeader header;
+  std::vector<Pixel> frame;                        // used by receiver thread only
+  std::vector<uint8_t> payload;                    // used by receiver thread only
+  FrameDifference frameDifference;                 // used by receiver thread only
+  FrameExchange frameExchange;
+  SdlWrapper sdlWrapper;
+  std::thread receiverThread;
+  std::atomic<bool> receivingFinished = false;
+  std::exception_ptr receiverException;
+
+  const std::chrono::milliseconds PRESENTER_POLL_INTERVAL = std::chrono::milliseconds(4);
+  const std::chrono::milliseconds WINDOW_REFRESH_INTERVAL = std::chrono::milliseconds(250);
+};
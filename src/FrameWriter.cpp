@@ -0,0 +1,111 @@
+#include "FrameWriter.h"
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+FrameWriter::FrameWriter(
+  const std::string& path,
+  int width,
+  int height
+) : mPath(path),
+    mWidth(width),
+    mHeight(height),
+    imageSequence(parseImageSequence()) {
+  if (imageSequence) {
+    buffer.reserve(static_cast<size_t>(width) * height * 3);
+    return;
+  }
+  buffer.reserve(static_cast<size_t>(width) * height * 4);
+  if (path == "-") {
+    rawStream = &std::cout;
+  } else {
+    fileStream = std::make_unique<std::ofstream>(path, std::ios::binary);
+    if (!*fileStream) {
+      throw std::runtime_error("Unable to open output file " + path);
+    }
+    rawStream = fileStream.get();
+  }
+}
+
+auto FrameWriter::write(std::span<const Pixel> pixels) -> void {
+  if (imageSequence) {
+    writePpm(pixels);
+  } else {
+    writeRaw(pixels);
+  }
+  frameCount++;
+}
+
+auto FrameWriter::skip() -> void {
+  frameCount++;
+}
+
+auto FrameWriter::getFrameCount() const -> uint64_t {
+  return frameCount;
+}
+
+// The path is user input, so the placeholder is replaced here instead of passing the path to printf as format.
+auto FrameWriter::parseImageSequence() -> bool {
+  const auto placeholder = mPath.find('%');
+  if (placeholder == std::string::npos) {
+    return false;
+  }
+  auto position = placeholder + 1;
+  if (position < mPath.size() && mPath[position] == '0') {
+    const auto digitsEnd = mPath.find_first_not_of("0123456789", position);
+    const auto digits = mPath.substr(position, digitsEnd == std::string::npos ? std::string::npos : digitsEnd - position);
+    if (digits.size() > 3 || std::stoul(digits) > MAX_FRAME_NUMBER_DIGITS) {
+      throw std::runtime_error("Frame number width in output path " + mPath + " is too large.");
+    }
+    frameNumberDigits = std::stoul(digits);
+    position += digits.size();
+  }
+  if (position >= mPath.size() || mPath[position] != 'd' || mPath.find('%', position) != std::string::npos) {
+    throw std::runtime_error("Output path " + mPath + " must contain exactly one frame number placeholder %d or %0Nd and no other %.");
+  }
+  fileNamePrefix = mPath.substr(0, placeholder);
+  fileNameSuffix = mPath.substr(position + 1);
+
+  return true;
+}
+
+auto FrameWriter::getFileName() const -> std::string {
+  const auto number = std::to_string(frameCount);
+  const auto padding = frameNumberDigits > number.size() ? frameNumberDigits - number.size() : 0;
+  return fileNamePrefix + std::string(padding, '0') + number + fileNameSuffix;
+}
+
+// Pixels are RGBA8888 (0xRRGGBBAA), PPM stores RGB only
+auto FrameWriter::writePpm(std::span<const Pixel> pixels) -> void {
+  const auto fileName = getFileName();
+
+  buffer.clear();
+  for (auto pixel : pixels) {
+    buffer.push_back(static_cast<uint8_t>(pixel >> 24));
+    buffer.push_back(static_cast<uint8_t>(pixel >> 16));
+    buffer.push_back(static_cast<uint8_t>(pixel >> 8));
+  }
+
+  std::ofstream file(fileName, std::ios::binary);
+  file << "P6\n"
+       << mWidth << " " << mHeight << "\n255\n";
+  file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+  if (!file) {
+    throw std::runtime_error("Unable to write frame to " + fileName);
+  }
+}
+
+auto FrameWriter::writeRaw(std::span<const Pixel> pixels) -> void {
+  buffer.clear();
+  for (auto pixel : pixels) {
+    buffer.push_back(static_cast<uint8_t>(pixel >> 24));
+    buffer.push_back(static_cast<uint8_t>(pixel >> 16));
+    buffer.push_back(static_cast<uint8_t>(pixel >> 8));
+    buffer.push_back(static_cast<uint8_t>(pixel));
+  }
+  rawStream->write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+  if (!*rawStream) {
+    throw std::runtime_error("Unable to write frame to " + mPath);
+  }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "SdlWrapper.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Writes frames either as a sequence of PPM images (path contains a frame number placeholder %d or %0Nd, e.g.
+// frame_%05d.ppm) or as a raw RGBA stream (any other path, "-" for stdout).
+class FrameWriter final {
+public:
+  FrameWriter(const std::string& path, int width, int height);
+
+  auto write(std::span<const Pixel> pixels) -> void;
+  // Leave out a frame: image sequences keep the frame number, so the gap shows that the previous image repeats
+  auto skip() -> void;
+
+  [[nodiscard]] auto getFrameCount() const -> uint64_t;
+
+private:
+  // Split the path at the frame number placeholder, returns false when there is none
+  auto parseImageSequence() -> bool;
+  [[nodiscard]] auto getFileName() const -> std::string;
+  auto writePpm(std::span<const Pixel> pixels) -> void;
+  auto writeRaw(std::span<const Pixel> pixels) -> void;
+
+  const std::string mPath;
+  const int mWidth;
+  const int mHeight;
+  std::string fileNamePrefix;  // image sequence: path before and after the frame number
+  std::string fileNameSuffix;
+  size_t frameNumberDigits = 0; // zero padded to this width
+  const bool imageSequence;
+  std::unique_ptr<std::ofstream> fileStream;
+  std::ostream* rawStream = nullptr;
+  std::vector<uint8_t> buffer;
+  uint64_t frameCount = 0;
+
+  static constexpr size_t MAX_FRAME_NUMBER_DIGITS = 20; // of a uint64_t
+};
@@ -6,51 +6,58 @@
 #include <ostream>
 #include <stdexcept>
 
-HardwareDataSource::HardwareDataSource(
-  SampleDataDispatcher& dataDispatcher,
+template <typename T>
+HardwareDataSource<T>::HardwareDataSource(
+  DataDispatcher<T>& dataDispatcher,
   const DataSourceConfiguration& config
-) : DataSource(dataDispatcher, config),
-    device(getDevice(mConfig.driverName)) {
+) : DataSource<T>(dataDispatcher, config),
+    device(getDevice(this->mConfig.driverName, this->mConfig.deviceIndex)) {
   if (!device) {
-    throw std::runtime_error(mConfig.driverName ? "Device not found." : "No device found.");
+    throw std::runtime_error(this->mConfig.driverName ? "Device not found." : "No device found.");
   }
-  for (auto channelIndex : mConfig.enabledChannels) {
+  for (const auto& channel : device->channels()) {
+    this->channelNames.push_back(channel->name());
+  }
+  for (auto channelIndex : this->mConfig.enabledChannels) {
     device->channels().at(channelIndex)->set_enabled(true);
   }
   device->open();
 
   try {
-    device->config_set(sigrok::ConfigKey::SAMPLERATE, Glib::Variant<guint64>::create(mConfig.sampleRate));
+    device->config_set(sigrok::ConfigKey::SAMPLERATE, Glib::Variant<guint64>::create(this->mConfig.sampleRate));
   } catch (std::exception& e) {
     throw std::runtime_error("Unable to set sample rate. Use sigrok-cli --scan and sigrok-cli --show -d <drivername> to look up supported sample rates.");
   }
-  sampleRate = mConfig.sampleRate;
+  this->sampleRate = this->mConfig.sampleRate;
 
-  session = context->create_session();
-  session->add_device(device);
+  this->session = this->context->create_session();
+  this->session->add_device(device);
 }
 
-auto HardwareDataSource::run() -> void {
+template <typename T>
+auto HardwareDataSource<T>::run() -> void {
   try {
-    session->add_datafeed_callback([this](std::shared_ptr<sigrok::Device> device, std::shared_ptr<sigrok::Packet> packet) {
-      handlePacket(device, packet);
+    this->session->add_datafeed_callback([this](std::shared_ptr<sigrok::Device> device, std::shared_ptr<sigrok::Packet> packet) {
+      this->handlePacket(device, packet);
     });
 
-    while (!mDataDispatcher.isClosed()) {
-      session->start();
-      session->run(); // event loop, exited when session->stop() is called
+    while (!this->mDataDispatcher.isClosed()) {
+      this->session->start();
+      this->session->run(); // event loop, exited when session->stop() is called
     }
 
     device->close();
   } catch (std::exception& e) {
     std::cerr << "Exception in data source thread: " << e.what() << std::endl;
-    mDataDispatcher.close();
+    this->mDataDispatcher.close();
   }
 }
 
-// Return either the first device with matching driverName or the first non-demo device.
-auto HardwareDataSource::getDevice(std::optional<std::string> driverName) -> std::shared_ptr<sigrok::HardwareDevice> const {
-  for (auto& [key, driver] : context->drivers()) {
+// Return either the device with matching driverName or a non-demo device. deviceIndex counts the devices found
+// (in driver order), so several identical analyzers can be told apart.
+template <typename T>
+auto HardwareDataSource<T>::getDevice(std::optional<std::string> driverName, unsigned int deviceIndex) -> std::shared_ptr<sigrok::HardwareDevice> const {
+  for (auto& [key, driver] : this->context->drivers()) {
     const auto keys = driver->config_keys();
     if (!keys.count(sigrok::ConfigKey::LOGIC_ANALYZER)) {
       continue;
@@ -66,16 +73,20 @@ auto HardwareDataSource::getDevice(std::optional<std::string> driverName) -> std
     }
     std::map<const sigrok::ConfigKey*, Glib::VariantBase> drvopts;
     auto devices = driver->scan(drvopts);
-    if (devices.size() < 1) {
+    if (devices.size() <= deviceIndex) {
       if (driverName) {
         return nullptr; // requested device not found
       } else {
+        deviceIndex -= static_cast<unsigned int>(devices.size());
         continue;
       }
     }
 
-    return devices.at(0);
+    return devices.at(deviceIndex);
   }
 
   return nullptr;
 }
+
+template class HardwareDataSource<Sample>;
+template class HardwareDataSource<WideSample>;
@@ -4,16 +4,17 @@
 #include <libsigrokcxx/libsigrokcxx.hpp>
 #include <memory>
 
-class HardwareDataSource final : public DataSource {
+template <typename T>
+class HardwareDataSource final : public DataSource<T> {
 public:
   HardwareDataSource(
-    SampleDataDispatcher& dataDispatcher,
+    DataDispatcher<T>& dataDispatcher,
     const DataSourceConfiguration& config
   );
   auto run() -> void override;
 
 private:
-  [[nodiscard]] auto getDevice(std::optional<std::string> driverName) -> std::shared_ptr<sigrok::HardwareDevice> const;
+  [[nodiscard]] auto getDevice(std::optional<std::string> driverName, unsigned int deviceIndex) -> std::shared_ptr<sigrok::HardwareDevice> const;
 
   std::shared_ptr<sigrok::Device> device = nullptr;
 };
@@ -0,0 +1,60 @@
+#include "InMemoryCapture.h"
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+template <typename T>
+InMemoryCapture<T>::InMemoryCapture(const DataSourceConfiguration& config) {
+  if (!config.inputFile) {
+    throw std::runtime_error("No input file was passed.");
+  }
+  if (NativeCapture::isNativeCapture(config.inputFile.value())) {
+    auto capture = std::make_unique<NativeCapture>(config.inputFile.value());
+    if (capture->getHeader().unitSize == sizeof(T)) {
+      nativeCapture = std::move(capture);
+      sampleRate = nativeCapture->getHeader().sampleRate;
+      return;
+    }
+    // other sample width: converted while reading it like any other file
+  }
+
+  DataSourceConfiguration singlePassConfig = config;
+  singlePassConfig.keepGoing = false;
+  DataDispatcher<T> dataDispatcher;
+  auto dataSource = DataSource<T>::create(dataDispatcher, singlePassConfig);
+  sampleRate = dataSource->getSampleRate();
+
+  std::thread dataSourceThread([&dataSource]() {
+    dataSource->run();
+  });
+
+  while (true) {
+    auto optionalData = dataDispatcher.get(std::chrono::milliseconds(250));
+    if (optionalData) {
+      samples.insert(samples.end(), optionalData->begin(), optionalData->end());
+      dataDispatcher.clear();
+    } else if (dataDispatcher.isClosed()) {
+      break;
+    }
+  }
+  dataSourceThread.join();
+}
+
+template <typename T>
+auto InMemoryCapture<T>::getSamples() -> std::span<T> {
+  return nativeCapture ? nativeCapture->getSamples<T>() : std::span<T>(samples);
+}
+
+template <typename T>
+auto InMemoryCapture<T>::getSampleRate() const -> uint64_t {
+  return sampleRate;
+}
+
+template <typename T>
+auto InMemoryCapture<T>::getNativeCapture() const -> const NativeCapture* {
+  return nativeCapture.get();
+}
+
+template class InMemoryCapture<Sample>;
+template class InMemoryCapture<WideSample>;
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "DataSource.h"
+#include "NativeCapture.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Complete recorded capture for random access: native captures are memory-mapped,
+// everything else is read through the regular data source.
+template <typename T>
+class InMemoryCapture final {
+public:
+  explicit InMemoryCapture(const DataSourceConfiguration& config);
+
+  [[nodiscard]] auto getSamples() -> std::span<T>;
+  [[nodiscard]] auto getSampleRate() const -> uint64_t;
+  // Native capture with embedded frame index, if any
+  [[nodiscard]] auto getNativeCapture() const -> const NativeCapture*;
+
+private:
+  std::unique_ptr<NativeCapture> nativeCapture;
+  std::vector<T> samples;
+  uint64_t sampleRate = 0;
+};
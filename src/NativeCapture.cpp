@@ -0,0 +1,89 @@
+#include "NativeCapture.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NativeCapture::NativeCapture(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Unable to open capture " + path);
+  }
+  struct stat fileStatus {};
+  if (fstat(fd, &fileStatus) != 0 || static_cast<size_t>(fileStatus.st_size) < sizeof(NativeCaptureHeader)) {
+    ::close(fd);
+    throw std::runtime_error("Capture " + path + " is truncated.");
+  }
+  mappingSize = static_cast<size_t>(fileStatus.st_size);
+
+  // Private writable mapping: consumers get mutable spans, but nothing is ever written back to the file.
+  mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    mapping = nullptr;
+    throw std::runtime_error("Unable to map capture " + path);
+  }
+  madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+  header = static_cast<const NativeCaptureHeader*>(mapping);
+  if (header->magic != NativeCaptureHeader::MAGIC || header->version != NativeCaptureHeader::VERSION) {
+    munmap(mapping, mappingSize);
+    throw std::runtime_error(path + " is not a supported vidgrok capture.");
+  }
+  // Compared by division, so that a crafted count can't wrap the end offset around into the mapping
+  const bool validUnitSize = header->unitSize == sizeof(Sample) || header->unitSize == sizeof(WideSample);
+  const bool validData = validUnitSize && header->dataOffset <= mappingSize && header->sampleCount <= (mappingSize - header->dataOffset) / header->unitSize;
+  const bool validFrameIndex = header->frameIndexOffset <= mappingSize && header->frameCount <= (mappingSize - header->frameIndexOffset) / sizeof(uint64_t);
+  if (!validData || !validFrameIndex || header->frameIndexOffset % sizeof(uint64_t) != 0) {
+    munmap(mapping, mappingSize);
+    throw std::runtime_error("Capture " + path + " is corrupt or uses an unsupported sample size.");
+  }
+}
+
+NativeCapture::~NativeCapture() {
+  if (mapping) {
+    munmap(mapping, mappingSize);
+  }
+}
+
+auto NativeCapture::isNativeCapture(const std::string& path) -> bool {
+  std::ifstream file(path, std::ios::binary);
+  std::array<char, 8> magic = {};
+  file.read(magic.data(), magic.size());
+
+  return file && magic == NativeCaptureHeader::MAGIC;
+}
+
+auto NativeCapture::getHeader() const -> const NativeCaptureHeader& {
+  return *header;
+}
+
+template <typename T>
+auto NativeCapture::getSamples() const -> std::span<T> {
+  if (header->unitSize != sizeof(T)) {
+    throw std::logic_error("Requested sample type doesn't match the unit size of the capture.");
+  }
+  return std::span<T>(reinterpret_cast<T*>(static_cast<uint8_t*>(mapping) + header->dataOffset), header->sampleCount);
+}
+
+auto NativeCapture::getFrameIndex() const -> std::span<const uint64_t> {
+  const auto* base = static_cast<const uint8_t*>(mapping) + header->frameIndexOffset;
+  return std::span<const uint64_t>(reinterpret_cast<const uint64_t*>(base), header->frameCount);
+}
+
+auto NativeCapture::getChannelNames() const -> std::vector<std::string> {
+  std::vector<std::string> names;
+  for (size_t i = 0; i < std::min<size_t>(header->channelCount, NativeCaptureHeader::MAX_CHANNELS); i++) {
+    const auto& name = header->channelNames[i];
+    names.emplace_back(name.data(), strnlen(name.data(), name.size()));
+  }
+
+  return names;
+}
+
+template auto NativeCapture::getSamples<Sample>() const -> std::span<Sample>;
+template auto NativeCapture::getSamples<WideSample>() const -> std::span<WideSample>;
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Uncompressed capture container ("vidgrok capture", *.vgc) that can be memory-mapped and replayed without copying.
+//
+// Layout (host byte order):
+//   NativeCaptureHeader (padded to DATA_ALIGNMENT)
+//   samples (sampleCount * unitSize bytes, starting at dataOffset)
+//   frame index (frameCount * uint64_t sample offsets of vertical syncs, starting at frameIndexOffset)
+struct NativeCaptureHeader {
+  static constexpr std::array<char, 8> MAGIC = {'V', 'I', 'D', 'G', 'R', 'O', 'K', 'C'};
+  static constexpr uint32_t VERSION = 1;
+  static constexpr size_t MAX_CHANNELS = 16;
+  static constexpr size_t CHANNEL_NAME_LENGTH = 16;
+  static constexpr size_t DATA_ALIGNMENT = 4096;
+
+  std::array<char, 8> magic = MAGIC;
+  uint32_t version = VERSION;
+  uint32_t unitSize = sizeof(Sample);
+  uint64_t sampleRate = 0;
+  uint64_t sampleCount = 0;
+  uint64_t dataOffset = DATA_ALIGNMENT;
+  uint64_t frameIndexOffset = 0;
+  uint64_t frameCount = 0;
+  uint8_t frameIndexVSyncChannel = 0; // channel the frame index was built from
+  uint8_t frameIndexVSyncInverted = 0;
+  uint8_t channelCount = 0;
+  uint8_t reserved[5] = {};
+  std::array<std::array<char, CHANNEL_NAME_LENGTH>, MAX_CHANNELS> channelNames = {};
+};
+
+// Read-only view of a memory-mapped native capture
+class NativeCapture final {
+public:
+  explicit NativeCapture(const std::string& path);
+  ~NativeCapture();
+  NativeCapture(const NativeCapture&) = delete;
+  auto operator=(const NativeCapture&) -> NativeCapture& = delete;
+
+  // Check magic without mapping the file
+  [[nodiscard]] static auto isNativeCapture(const std::string& path) -> bool;
+
+  [[nodiscard]] auto getHeader() const -> const NativeCaptureHeader&;
+  // Samples of the capture; T has to match the unit size
+  template <typename T>
+  [[nodiscard]] auto getSamples() const -> std::span<T>;
+  [[nodiscard]] auto getFrameIndex() const -> std::span<const uint64_t>;
+  [[nodiscard]] auto getChannelNames() const -> std::vector<std::string>;
+
+private:
+  void* mapping = nullptr;
+  size_t mappingSize = 0;
+  const NativeCaptureHeader* header = nullptr;
+};
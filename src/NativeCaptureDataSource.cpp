@@ -0,0 +1,52 @@
+#include "NativeCaptureDataSource.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+template <typename T>
+NativeCaptureDataSource<T>::NativeCaptureDataSource(
+  DataDispatcher<T>& dataDispatcher,
+  const DataSourceConfiguration& config
+) : DataSource<T>(dataDispatcher, config),
+    capture(config.inputFile.value()) {
+  this->sampleRate = capture.getHeader().sampleRate;
+  this->channelNames = capture.getChannelNames();
+}
+
+template <typename T>
+auto NativeCaptureDataSource<T>::run() -> void {
+  try {
+    do {
+      if (capture.getHeader().unitSize == sizeof(T)) {
+        replay(capture.getSamples<T>());
+      } else if (capture.getHeader().unitSize == sizeof(Sample)) {
+        replay(capture.getSamples<Sample>());
+      } else {
+        replay(capture.getSamples<WideSample>());
+      }
+    } while (this->mConfig.keepGoing && !this->mDataDispatcher.isClosed());
+  } catch (std::exception& e) {
+    std::cerr << "Exception in data source thread: " << e.what() << std::endl;
+  }
+  this->mDataDispatcher.close();
+}
+
+// Blocks of matching sample type are passed without copying, others are converted
+template <typename T>
+template <typename U>
+auto NativeCaptureDataSource<T>::replay(std::span<U> samples) -> void {
+  for (size_t offset = 0; offset < samples.size() && !this->mDataDispatcher.isClosed(); offset += BLOCK_SIZE) {
+    const auto block = samples.subspan(offset, std::min(BLOCK_SIZE, samples.size() - offset));
+    this->countPacket(block.size_bytes());
+    this->countBlock(block.size() * sizeof(T)); // large enough, not coalesced
+    if constexpr (std::is_same_v<T, U>) {
+      this->mDataDispatcher.putBorrowed(block);
+    } else {
+      this->mDataDispatcher.putConverted(std::span<const U>(block));
+    }
+  }
+}
+
+template class NativeCaptureDataSource<Sample>;
+template class NativeCaptureDataSource<WideSample>;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "DataSource.h"
+#include "NativeCapture.h"
+#include <span>
+
+// Replays a memory-mapped native capture. Blocks are handed to the dispatcher without copying
+// (unless the capture was recorded with another sample width).
+template <typename T>
+class NativeCaptureDataSource final : public DataSource<T> {
+public:
+  NativeCaptureDataSource(
+    DataDispatcher<T>& dataDispatcher,
+    const DataSourceConfiguration& config
+  );
+  auto run() -> void override;
+
+private:
+  template <typename U>
+  auto replay(std::span<U> samples) -> void;
+
+  NativeCapture capture;
+
+  static constexpr size_t BLOCK_SIZE = 64 * 1024; // similar to libsigrok packets, keeps rendering responsive
+};
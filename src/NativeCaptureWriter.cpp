@@ -0,0 +1,107 @@
+#include "NativeCaptureWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+template <typename T>
+NativeCaptureWriter<T>::NativeCaptureWriter(
+  const std::string& path,
+  uint64_t sampleRate,
+  const std::vector<std::string>& channelNames,
+  uint8_t vSyncChannel,
+  bool invertVSync
+) : mPath(path),
+    file(path, std::ios::binary | std::ios::trunc),
+    frameIndexer(vSyncChannel, invertVSync),
+    writeBlock(WRITE_BLOCK_SIZE) {
+  if (!file) {
+    throw std::runtime_error("Unable to create capture " + path);
+  }
+  header.unitSize = sizeof(T);
+  header.sampleRate = sampleRate;
+  header.frameIndexVSyncChannel = vSyncChannel;
+  header.frameIndexVSyncInverted = invertVSync ? 1 : 0;
+  header.channelCount = static_cast<uint8_t>(std::min(channelNames.size(), NativeCaptureHeader::MAX_CHANNELS));
+  for (size_t i = 0; i < header.channelCount; i++) {
+    const auto length = std::min(channelNames[i].size(), NativeCaptureHeader::CHANNEL_NAME_LENGTH - 1);
+    std::memcpy(header.channelNames[i].data(), channelNames[i].data(), length);
+  }
+
+  // Placeholder, rewritten by finish()
+  const std::vector<char> padding(header.dataOffset, 0);
+  file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+}
+
+template <typename T>
+NativeCaptureWriter<T>::~NativeCaptureWriter() {
+  try {
+    finish();
+  } catch (std::exception& e) {
+    std::cerr << "Error while finishing capture: " << e.what() << std::endl;
+  }
+}
+
+template <typename T>
+auto NativeCaptureWriter<T>::write(std::span<const T> samples) -> void {
+  frameIndexer.scan(samples);
+  // Collected into large blocks, so the file is written in few page-aligned chunks (the data starts at a page boundary)
+  const auto* bytes = reinterpret_cast<const char*>(samples.data());
+  size_t remaining = samples.size_bytes();
+  while (remaining > 0) {
+    const auto count = std::min(remaining, writeBlock.size() - writeBlockFill);
+    std::memcpy(writeBlock.data() + writeBlockFill, bytes, count);
+    writeBlockFill += count;
+    bytes += count;
+    remaining -= count;
+    if (writeBlockFill == writeBlock.size()) {
+      flushWriteBlock();
+    }
+  }
+  header.sampleCount += samples.size();
+}
+
+template <typename T>
+auto NativeCaptureWriter<T>::flushWriteBlock() -> void {
+  file.write(writeBlock.data(), static_cast<std::streamsize>(writeBlockFill));
+  if (!file) {
+    throw std::runtime_error("Unable to write to capture " + mPath);
+  }
+  writeBlockFill = 0;
+}
+
+template <typename T>
+auto NativeCaptureWriter<T>::finish() -> void {
+  if (finished) {
+    return;
+  }
+  finished = true;
+
+  flushWriteBlock();
+  header.frameIndexOffset = header.dataOffset + header.sampleCount * header.unitSize;
+  const auto misalignment = header.frameIndexOffset % sizeof(uint64_t);
+  if (misalignment != 0) {
+    const std::vector<char> padding(sizeof(uint64_t) - misalignment, 0);
+    file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    header.frameIndexOffset += padding.size();
+  }
+  const auto& frameIndex = frameIndexer.getFrameStarts();
+  header.frameCount = frameIndex.size();
+  file.write(reinterpret_cast<const char*>(frameIndex.data()), static_cast<std::streamsize>(frameIndex.size() * sizeof(uint64_t)));
+
+  file.seekp(0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.close();
+  if (!file) {
+    throw std::runtime_error("Unable to finish capture " + mPath);
+  }
+}
+
+template <typename T>
+auto NativeCaptureWriter<T>::getSampleCount() const -> uint64_t {
+  return header.sampleCount;
+}
+
+template class NativeCaptureWriter<Sample>;
+template class NativeCaptureWriter<WideSample>;
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "FrameIndexer.h"
+#include "NativeCapture.h"
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+// Streams samples into a native capture file. The frame index is built on the fly from the vertical sync channel
+// and written together with the final header by finish().
+template <typename T>
+class NativeCaptureWriter final {
+public:
+  NativeCaptureWriter(
+    const std::string& path,
+    uint64_t sampleRate,
+    const std::vector<std::string>& channelNames,
+    uint8_t vSyncChannel,
+    bool invertVSync
+  );
+  ~NativeCaptureWriter();
+
+  auto write(std::span<const T> samples) -> void;
+  auto finish() -> void;
+
+  [[nodiscard]] auto getSampleCount() const -> uint64_t;
+
+private:
+  auto flushWriteBlock() -> void;
+
+  const std::string mPath;
+  std::ofstream file;
+  NativeCaptureHeader header;
+  FrameIndexer<T> frameIndexer;
+  std::vector<char> writeBlock;
+  size_t writeBlockFill = 0;
+  bool finished = false;
+
+  static constexpr size_t WRITE_BLOCK_SIZE = 1024 * 1024;
+};
@@ -0,0 +1,129 @@
+#include "PacketCoalescer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+template <typename T>
+PacketCoalescer<T>::PacketCoalescer(
+  DataDispatcher<T>& dataDispatcher,
+  size_t maxBytes,
+  std::chrono::milliseconds maxLatency,
+  Statistics* statistics
+) : mDataDispatcher(dataDispatcher),
+    maxSamples(maxBytes == 0 ? 0 : std::clamp<size_t>(maxBytes / sizeof(T), 1, dataDispatcher.getArena().getBlockCapacity())),
+    mMaxLatency(maxLatency),
+    mStatistics(statistics) {
+  if (maxSamples > 0) {
+    flusherThread = std::thread([this]() { flushOnDeadline(); });
+  }
+}
+
+template <typename T>
+PacketCoalescer<T>::~PacketCoalescer() {
+  {
+    std::lock_guard lock(mutex);
+    stopRequested = true;
+  }
+  pendingStarted.notify_one();
+  if (flusherThread.joinable()) {
+    flusherThread.join();
+  }
+}
+
+template <typename T>
+auto PacketCoalescer<T>::add(const void* data, unsigned int unitSize, size_t sampleCount) -> void {
+  if (unitSize != 1 && unitSize != 2 && unitSize != 4) {
+    throw std::runtime_error("Unsupported sample size of " + std::to_string(unitSize) + " bytes.");
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  std::unique_lock lock(mutex);
+  const bool wasPending = static_cast<bool>(pending);
+  for (size_t offset = 0; offset < sampleCount;) {
+    if (!pending) {
+      pending = mDataDispatcher.getArena().acquire();
+      pendingSince = now;
+    }
+    const auto limit = maxSamples == 0 ? pending.getCapacity() : maxSamples;
+    const auto count = std::min(sampleCount - offset, limit - pending.getSize());
+    append(bytes + offset * unitSize, unitSize, count);
+    offset += count;
+    if (pending.getSize() == limit) {
+      flushPending();
+    }
+  }
+  if (maxSamples == 0 || (pending && now >= pendingSince + mMaxLatency)) {
+    flushPending();
+  }
+  // A new deadline for the flusher
+  if (pending && !wasPending) {
+    lock.unlock();
+    pendingStarted.notify_one();
+  }
+}
+
+template <typename T>
+auto PacketCoalescer<T>::flush() -> void {
+  std::lock_guard lock(mutex);
+  flushPending();
+}
+
+template <typename T>
+auto PacketCoalescer<T>::flushPending() -> void {
+  if (!pending) {
+    return;
+  }
+  countBlock(pending.getSize());
+  mDataDispatcher.putSlice(std::move(pending)); // the block returns to the arena when dropped
+  pending = typename SampleArena<T>::Slice();
+}
+
+// Flusher thread: passes on the pending samples when the data source hasn't done so by their deadline.
+template <typename T>
+auto PacketCoalescer<T>::flushOnDeadline() -> void {
+  std::unique_lock lock(mutex);
+  while (!stopRequested) {
+    if (!pending) {
+      pendingStarted.wait(lock);
+    } else if (std::chrono::steady_clock::now() >= pendingSince + mMaxLatency) {
+      flushPending();
+    } else {
+      pendingStarted.wait_until(lock, pendingSince + mMaxLatency);
+    }
+  }
+}
+
+template <typename T>
+auto PacketCoalescer<T>::append(const uint8_t* data, unsigned int unitSize, size_t sampleCount) -> void {
+  auto* target = pending.getData() + pending.getSize();
+  const auto appendConverted = [target, sampleCount]<typename U>(const U* values) {
+    std::transform(values, values + sampleCount, target, [](U value) { return static_cast<T>(value); });
+  };
+  switch (unitSize) {
+    case 1:
+      appendConverted(data);
+      break;
+    case 2:
+      appendConverted(reinterpret_cast<const uint16_t*>(data));
+      break;
+    default:
+      appendConverted(reinterpret_cast<const uint32_t*>(data));
+      break;
+  }
+  pending.setSize(pending.getSize() + sampleCount);
+}
+
+template <typename T>
+auto PacketCoalescer<T>::countBlock(size_t sampleCount) -> void {
+  if (mStatistics) {
+    mStatistics->blockCount.fetch_add(1, std::memory_order_relaxed);
+    mStatistics->blockSizes.add(sampleCount * sizeof(T));
+  }
+}
+
+template class PacketCoalescer<Sample>;
+template class PacketCoalescer<WideSample>;
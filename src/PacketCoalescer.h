@@ -0,0 +1,56 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "Statistics.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Collects the packets of a data source into larger blocks before they are handed to the dispatcher, so the fixed
+// costs per block (handoff, wake-up of the decoder, decoder call) are spread over more samples. Some drivers deliver
+// many packets of a few KiB only.
+// A block is passed on when it reaches the maximum size or when its oldest sample has waited for the latency deadline.
+// The deadline is kept by a flusher thread, so samples are not held back when the driver stalls or delivers slowly.
+// It only hands over blocks while the data source's thread doesn't (the mutex is uncontended otherwise).
+// Packets are copied once, straight into a block of the dispatcher's arena that is then handed over as it is.
+template <typename T>
+class PacketCoalescer final {
+public:
+  // maxBytes 0 passes every packet on as it is (limited by the arena's block size, like the coalesced blocks)
+  PacketCoalescer(
+    DataDispatcher<T>& dataDispatcher,
+    size_t maxBytes,
+    std::chrono::milliseconds maxLatency,
+    Statistics* statistics = nullptr
+  );
+  ~PacketCoalescer();
+  PacketCoalescer(const PacketCoalescer&) = delete;
+  auto operator=(const PacketCoalescer&) -> PacketCoalescer& = delete;
+
+  // Add packet of the given unit size in bytes (samples are widened or truncated to T, only the used channels have to
+  // fit)
+  auto add(const void* data, unsigned int unitSize, size_t sampleCount) -> void;
+  // Pass on the pending samples (e.g. at the end of data)
+  auto flush() -> void;
+
+private:
+  auto flushPending() -> void; // mutex held
+  auto flushOnDeadline() -> void;
+  auto append(const uint8_t* data, unsigned int unitSize, size_t sampleCount) -> void;
+  inline auto countBlock(size_t sampleCount) -> void;
+
+  DataDispatcher<T>& mDataDispatcher;
+  const size_t maxSamples;
+  const std::chrono::milliseconds mMaxLatency;
+  Statistics* mStatistics;
+
+  std::mutex mutex;
+  std::condition_variable pendingStarted;
+  bool stopRequested = false;
+  typename SampleArena<T>::Slice pending; // empty when nothing is pending
+  std::chrono::time_point<std::chrono::steady_clock> pendingSince;
+  std::thread flusherThread; // only when coalescing
+};
@@ -0,0 +1,136 @@
+#include "ParallelFrameExporter.h"
+#include "FrameDecoder.h"
+#include "FrameIndexer.h"
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+
+template <typename T>
+ParallelFrameExporter<T>::ParallelFrameExporter(
+  InMemoryCapture<T>& capture,
+  const VisualizerConfiguration& config,
+  unsigned int threadCount
+) : mCapture(capture),
+    mConfig(config),
+    mThreadCount(std::max(1U, threadCount)),
+    samples(capture.getSamples()),
+    frameWriter(mConfig.outputPath, mConfig.width, mConfig.height),
+    frameDifference(mConfig.width, mConfig.height),
+    slots(2 * mThreadCount, std::vector<Pixel>(static_cast<size_t>(mConfig.width) * mConfig.height)),
+    slotSegments(slots.size(), 0) {
+}
+
+template <typename T>
+auto ParallelFrameExporter<T>::run() -> void {
+  frameStarts = findFrameStarts();
+  if (frameStarts.size() < 2) {
+    return; // no complete frame
+  }
+
+  // The content before the first vertical sync is what remains visible where the first frame doesn't draw.
+  std::vector<Pixel> frame(slots[0].size(), 0);
+  {
+    FrameDecoder<T> frameDecoder(mConfig);
+    frameDecoder.setTarget(frame.data());
+    frameDecoder.decode(samples.subspan(0, frameStarts[0]));
+  }
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < mThreadCount; i++) {
+    workers.emplace_back([this]() { work(); });
+  }
+
+  try {
+    const size_t segmentCount = frameStarts.size() - 1;
+    for (size_t segment = 0; segment < segmentCount; segment++) {
+      auto& slot = slots[segment % slots.size()];
+      {
+        std::unique_lock lk(mutex);
+        conditionVariable.wait(lk, [&] { return slotSegments[segment % slots.size()] == segment + 1; });
+      }
+      for (size_t i = 0; i < frame.size(); i++) {
+        if (slot[i] != UNTOUCHED) {
+          frame[i] = slot[i];
+        }
+      }
+      if (mConfig.skipUnchangedFrames && frameDifference.update(frame) == 0) {
+        frameWriter.skip();
+      } else {
+        frameWriter.write(frame);
+      }
+      {
+        std::lock_guard lk(mutex);
+        writtenSegments++;
+      }
+      conditionVariable.notify_all();
+    }
+  } catch (std::exception& e) {
+    {
+      std::lock_guard lk(mutex);
+      aborted = true;
+    }
+    conditionVariable.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    throw;
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+// Use the frame index of native captures when it was built for the same vertical sync settings
+template <typename T>
+auto ParallelFrameExporter<T>::findFrameStarts() -> std::vector<uint64_t> {
+  const auto* nativeCapture = mCapture.getNativeCapture();
+  if (nativeCapture) {
+    const auto& header = nativeCapture->getHeader();
+    if (header.frameIndexVSyncChannel == mConfig.vSyncChannel && static_cast<bool>(header.frameIndexVSyncInverted) == mConfig.invertVSync) {
+      const auto frameIndex = nativeCapture->getFrameIndex();
+      return std::vector<uint64_t>(frameIndex.begin(), frameIndex.end());
+    }
+  }
+
+  return FrameIndexer<T>::findFrameStarts(samples, mConfig.vSyncChannel, mConfig.invertVSync, mThreadCount);
+}
+
+template <typename T>
+auto ParallelFrameExporter<T>::work() -> void {
+  const size_t segmentCount = frameStarts.size() - 1;
+  while (true) {
+    size_t segment = 0;
+    {
+      std::unique_lock lk(mutex);
+      conditionVariable.wait(lk, [&] { return aborted || nextSegment >= segmentCount || nextSegment < writtenSegments + slots.size(); });
+      if (aborted || nextSegment >= segmentCount) {
+        return;
+      }
+      segment = nextSegment++;
+    }
+
+    auto& slot = slots[segment % slots.size()];
+    decodeSegment(frameStarts[segment], frameStarts[segment + 1], slot);
+
+    {
+      std::lock_guard lk(mutex);
+      slotSegments[segment % slots.size()] = segment + 1;
+    }
+    conditionVariable.notify_all();
+  }
+}
+
+// Decode one frame (from its vertical sync up to the next one)
+template <typename T>
+auto ParallelFrameExporter<T>::decodeSegment(uint64_t start, uint64_t end, std::vector<Pixel>& frame) -> void {
+  std::fill(frame.begin(), frame.end(), UNTOUCHED);
+  FrameDecoder<T> frameDecoder(mConfig);
+  frameDecoder.setTarget(frame.data());
+  frameDecoder.reset(samples[start - 1]);
+  frameDecoder.decode(samples.subspan(start, end - start));
+}
+
+template class ParallelFrameExporter<Sample>;
+template class ParallelFrameExporter<WideSample>;
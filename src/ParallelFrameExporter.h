@@ -0,0 +1,49 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "FrameDifference.h"
+#include "FrameWriter.h"
+#include "InMemoryCapture.h"
+#include "VisualizerConfiguration.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Offline variant of FrameExporter: splits a complete capture at vertical syncs and decodes the frames on a pool
+// of worker threads. Frames are written in order and are identical to the sequentially decoded ones.
+template <typename T>
+class ParallelFrameExporter final {
+public:
+  ParallelFrameExporter(
+    InMemoryCapture<T>& capture,
+    const VisualizerConfiguration& config,
+    unsigned int threadCount
+  );
+
+  auto run() -> void;
+
+private:
+  auto findFrameStarts() -> std::vector<uint64_t>;
+  auto work() -> void;
+  auto decodeSegment(uint64_t start, uint64_t end, std::vector<Pixel>& frame) -> void;
+
+  InMemoryCapture<T>& mCapture;
+  const VisualizerConfiguration& mConfig;
+  const unsigned int mThreadCount;
+  const std::span<T> samples;
+  FrameWriter frameWriter;
+  FrameDifference frameDifference;
+
+  std::vector<uint64_t> frameStarts;
+  std::vector<std::vector<Pixel>> slots; // decoded segments waiting to be written (segment % slots.size())
+  std::vector<size_t> slotSegments;      // segment number + 1 of the finished segment in each slot
+  size_t nextSegment = 0;
+  size_t writtenSegments = 0;
+  bool aborted = false;
+  std::mutex mutex;
+  std::condition_variable conditionVariable;
+
+  // Marks pixels that were not written while decoding a segment. Decoded pixels are either fully opaque or 0.
+  static constexpr Pixel UNTOUCHED = 0x00000001;
+};
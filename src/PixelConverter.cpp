@@ -0,0 +1,343 @@
+#include "PixelConverter.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VIDGROK_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Intensity (0-255) of a color component spread over colorDepth channels, most significant channel first
+auto componentValue(unsigned int data, uint8_t mostSignificantChannel, uint8_t colorDepth, bool invertData) -> Pixel {
+  unsigned int value = 0;
+  for (unsigned int bit = 0; bit < colorDepth; bit++) {
+    value = (value << 1) | (((data >> (mostSignificantChannel - bit)) & 1) != static_cast<unsigned int>(invertData));
+  }
+
+  return value * 255 / ((1U << colorDepth) - 1);
+}
+
+// Inverse of channel extraction: spreads the bits of index over the bits set in mask (like BMI2 PDEP)
+auto depositBits(uint32_t index, uint32_t mask) -> uint32_t {
+  uint32_t result = 0;
+  for (uint32_t bit = 1; mask; bit <<= 1) {
+    const uint32_t lowest = mask & -mask;
+    if (index & bit) {
+      result |= lowest;
+    }
+    mask &= mask - 1;
+  }
+
+  return result;
+}
+
+// One specialization per flag combination, so evaluating a sample does not need to look at the configuration.
+template <bool highlightVSync, bool highlightHSync, bool renderHiddenData, bool invertData>
+auto fillLookupTable(PixelLookupTable& table, const VisualizerConfiguration& config) -> void {
+  const unsigned int vSyncChannelMask = 1 << config.vSyncChannel;
+  const unsigned int hSyncChannelMask = 1 << config.hSyncChannel;
+
+  for (uint32_t index = 0; index < table.pixels.size(); index++) {
+    const auto data = depositBits(index, table.channelMask);
+    // The vertical sync channel is not captured with composite sync (vertical sync pulses are part of the other one)
+    const bool vSyncActive = !config.compositeSync && config.invertVSync == static_cast<bool>(data & vSyncChannelMask);
+    const bool hSyncActive = config.invertHSync == static_cast<bool>(data & hSyncChannelMask);
+    Pixel value = 0;
+    if (highlightVSync && vSyncActive) {
+      value |= 0x3f0000ff;
+    }
+    if (highlightHSync && hSyncActive) {
+      value |= 0x00003fff;
+    }
+    if ((!vSyncActive && !hSyncActive) || renderHiddenData) {
+      const auto red = componentValue(data, config.dataRedChannel, config.colorDepth, invertData);
+      const auto green = componentValue(data, config.dataGreenChannel, config.colorDepth, invertData);
+      const auto blue = componentValue(data, config.dataBlueChannel, config.colorDepth, invertData);
+      if (red || green || blue) {
+        value |= (red << 24) | (green << 16) | (blue << 8) | 0xff;
+      }
+    }
+    table.pixels[index] = value;
+  }
+}
+
+template <size_t... combinations>
+constexpr auto makeLookupTableFillers(std::index_sequence<combinations...>) {
+  return std::array{&fillLookupTable<(combinations & 8) != 0, (combinations & 4) != 0, (combinations & 2) != 0, (combinations & 1) != 0>...};
+}
+
+// Table index of a sample: 8 bit samples are used directly, wide samples are compacted byte by byte
+template <typename T>
+inline auto tableIndex(const PixelLookupTable& table, T sample) -> uint32_t {
+  if constexpr (sizeof(T) == 1) {
+    return sample;
+  } else {
+    return table.lowByteIndices[sample & 0xff] | table.highByteIndices[sample >> 8];
+  }
+}
+
+template <typename T>
+auto convertScalar(const PixelLookupTable& table, std::span<const T> samples, Pixel* pixels) -> void {
+  for (size_t i = 0; i < samples.size(); i++) {
+    pixels[i] = table.pixels[tableIndex(table, samples[i])];
+  }
+}
+
+#ifdef VIDGROK_X86
+
+// SSE2 has no gather, so it only speeds up uniform blocks (blanking, backgrounds) and looks up the rest one by one.
+__attribute__((target("sse2"))) auto convertSse2(const PixelLookupTable& table, std::span<const Sample> samples, Pixel* pixels) -> void {
+  const size_t size = samples.size();
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+    const __m128i first = _mm_set1_epi8(static_cast<char>(samples[i]));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, first)) == 0xffff) {
+      const __m128i value = _mm_set1_epi32(static_cast<int>(table.pixels[samples[i]]));
+      for (size_t j = 0; j < 16; j += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&pixels[i + j]), value);
+      }
+    } else {
+      for (size_t j = 0; j < 16; j++) {
+        pixels[i + j] = table.pixels[samples[i + j]];
+      }
+    }
+  }
+  convertScalar(table, samples.subspan(i), pixels + i);
+}
+
+// 32 samples per iteration: uniform blocks are broadcast, everything else goes through 4 table gathers.
+__attribute__((target("avx2"))) auto convertAvx2(const PixelLookupTable& table, std::span<const Sample> samples, Pixel* pixels) -> void {
+  const size_t size = samples.size();
+  const auto* base = reinterpret_cast<const int*>(table.pixels.data());
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&samples[i]));
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(samples[i]));
+    if (static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, first))) == 0xffffffff) {
+      const __m256i value = _mm256_set1_epi32(static_cast<int>(table.pixels[samples[i]]));
+      for (size_t j = 0; j < 32; j += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&pixels[i + j]), value);
+      }
+    } else {
+      for (size_t j = 0; j < 32; j += 8) {
+        const __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&samples[i + j])));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&pixels[i + j]), _mm256_i32gather_epi32(base, indices, 4));
+      }
+    }
+  }
+  convertScalar(table, samples.subspan(i), pixels + i);
+}
+
+// Wide samples, 8 per iteration: uniform blocks are broadcast, the rest is compacted with two byte-wise lookups.
+__attribute__((target("sse2"))) auto convertSse2(const PixelLookupTable& table, std::span<const WideSample> samples, Pixel* pixels) -> void {
+  const size_t size = samples.size();
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+    const __m128i first = _mm_set1_epi16(static_cast<short>(samples[i]));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(block, first)) == 0xffff) {
+      const __m128i value = _mm_set1_epi32(static_cast<int>(table.pixels[tableIndex(table, samples[i])]));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&pixels[i]), value);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&pixels[i + 4]), value);
+    } else {
+      for (size_t j = 0; j < 8; j++) {
+        pixels[i + j] = table.pixels[tableIndex(table, samples[i + j])];
+      }
+    }
+  }
+  convertScalar(table, samples.subspan(i), pixels + i);
+}
+
+// Same as above, but the channels are compacted with a single PEXT (slow on AMD CPUs before Zen 3, see selectKernel)
+__attribute__((target("sse2,bmi2"))) auto convertBmi2(const PixelLookupTable& table, std::span<const WideSample> samples, Pixel* pixels) -> void {
+  const size_t size = samples.size();
+  const uint32_t mask = table.channelMask;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+    const __m128i first = _mm_set1_epi16(static_cast<short>(samples[i]));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(block, first)) == 0xffff) {
+      const __m128i value = _mm_set1_epi32(static_cast<int>(table.pixels[_pext_u32(samples[i], mask)]));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&pixels[i]), value);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&pixels[i + 4]), value);
+    } else {
+      for (size_t j = 0; j < 8; j++) {
+        pixels[i + j] = table.pixels[_pext_u32(samples[i + j], mask)];
+      }
+    }
+  }
+  for (; i < size; i++) {
+    pixels[i] = table.pixels[_pext_u32(samples[i], mask)];
+  }
+}
+
+// Wide samples, 16 per iteration: the byte-wise channel extraction and the pixel lookup are done with gathers.
+__attribute__((target("avx2"))) auto convertAvx2(const PixelLookupTable& table, std::span<const WideSample> samples, Pixel* pixels) -> void {
+  const size_t size = samples.size();
+  const auto* base = reinterpret_cast<const int*>(table.pixels.data());
+  const auto* lowBase = reinterpret_cast<const int*>(table.lowByteIndices.data());
+  const auto* highBase = reinterpret_cast<const int*>(table.highByteIndices.data());
+  const __m256i lowByte = _mm256_set1_epi32(0xff);
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&samples[i]));
+    const __m256i first = _mm256_set1_epi16(static_cast<short>(samples[i]));
+    if (static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(block, first))) == 0xffffffff) {
+      const __m256i value = _mm256_set1_epi32(static_cast<int>(table.pixels[tableIndex(table, samples[i])]));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(&pixels[i]), value);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(&pixels[i + 8]), value);
+    } else {
+      for (size_t j = 0; j < 16; j += 8) {
+        const __m256i values = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i + j])));
+        const __m256i low = _mm256_i32gather_epi32(lowBase, _mm256_and_si256(values, lowByte), 4);
+        const __m256i high = _mm256_i32gather_epi32(highBase, _mm256_srli_epi32(values, 8), 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&pixels[i + j]), _mm256_i32gather_epi32(base, _mm256_or_si256(low, high), 4));
+      }
+    }
+  }
+  convertScalar(table, samples.subspan(i), pixels + i);
+}
+
+#endif
+
+} // namespace
+
+template <typename T>
+PixelConverter<T>::PixelConverter(
+  const VisualizerConfiguration& config,
+  Kernel kernel
+) : lookupTable(buildLookupTable(config)),
+    mKernel(selectKernel(kernel)),
+    convertFunction(getConvertFunction(mKernel)) {
+}
+
+template <typename T>
+auto PixelConverter<T>::buildLookupTable(const VisualizerConfiguration& config) -> PixelLookupTable {
+  PixelLookupTable table;
+  if constexpr (sizeof(T) == 1) {
+    table.channelMask = 0xff;
+  } else {
+    table.channelMask = (1U << config.vSyncChannel) | (1U << config.hSyncChannel);
+    for (unsigned int bit = 0; bit < config.colorDepth; bit++) {
+      table.channelMask |= (1U << (config.dataRedChannel - bit)) | (1U << (config.dataGreenChannel - bit)) | (1U << (config.dataBlueChannel - bit));
+    }
+  }
+  table.pixels.resize(size_t(1) << std::popcount(table.channelMask));
+
+  // Index bits of each byte value: the used channels of a byte keep their order and follow those of the lower byte
+  const auto lowMask = table.channelMask & 0xff;
+  const auto highMask = (table.channelMask >> 8) & 0xff;
+  for (uint32_t value = 0; value < 256; value++) {
+    uint32_t lowIndex = 0;
+    uint32_t highIndex = 0;
+    for (uint32_t bit = 0, lowPosition = 0, highPosition = 0; bit < 8; bit++) {
+      if (lowMask & (1U << bit)) {
+        lowIndex |= ((value >> bit) & 1) << lowPosition++;
+      }
+      if (highMask & (1U << bit)) {
+        highIndex |= ((value >> bit) & 1) << highPosition++;
+      }
+    }
+    table.lowByteIndices[value] = lowIndex;
+    table.highByteIndices[value] = highIndex << std::popcount(lowMask);
+  }
+
+  static constexpr auto fillers = makeLookupTableFillers(std::make_index_sequence<16>());
+  const size_t combination = (config.highlightVSync ? 8 : 0) | (config.highlightHSync ? 4 : 0) | (config.renderHiddenData ? 2 : 0) | (config.invertData ? 1 : 0);
+  fillers[combination](table, config);
+
+  return table;
+}
+
+template <typename T>
+auto PixelConverter<T>::isSupported(Kernel kernel) -> bool {
+  switch (kernel) {
+    case Kernel::Auto:
+    case Kernel::Scalar:
+      return true;
+#ifdef VIDGROK_X86
+    case Kernel::Sse2:
+      return __builtin_cpu_supports("sse2");
+    case Kernel::Avx2:
+      return __builtin_cpu_supports("avx2");
+    case Kernel::Bmi2:
+      return sizeof(T) > 1 && __builtin_cpu_supports("sse2") && __builtin_cpu_supports("bmi2");
+#else
+    default:
+      return false;
+#endif
+  }
+
+  return false;
+}
+
+template <typename T>
+auto PixelConverter<T>::getKernelName(Kernel kernel) -> std::string {
+  switch (kernel) {
+    case Kernel::Auto:
+      return "auto";
+    case Kernel::Scalar:
+      return "scalar";
+    case Kernel::Sse2:
+      return "sse2";
+    case Kernel::Avx2:
+      return "avx2";
+    case Kernel::Bmi2:
+      return "bmi2";
+  }
+
+  return "unknown";
+}
+
+template <typename T>
+auto PixelConverter<T>::selectKernel(Kernel kernel) -> Kernel {
+  if (kernel != Kernel::Auto) {
+    if (!isSupported(kernel)) {
+      throw std::runtime_error("Conversion kernel " + getKernelName(kernel) + " is not supported by this CPU.");
+    }
+    return kernel;
+  }
+  for (auto candidate : {Kernel::Avx2, Kernel::Bmi2, Kernel::Sse2}) {
+#ifdef VIDGROK_X86
+    // PEXT is microcoded (hundreds of cycles) on these, the table extraction is much faster
+    if (candidate == Kernel::Bmi2 && (__builtin_cpu_is("znver1") || __builtin_cpu_is("znver2"))) {
+      continue;
+    }
+#endif
+    if (isSupported(candidate)) {
+      return candidate;
+    }
+  }
+
+  return Kernel::Scalar;
+}
+
+template <typename T>
+auto PixelConverter<T>::getConvertFunction(Kernel kernel) -> ConvertFunction {
+  switch (kernel) {
+#ifdef VIDGROK_X86
+    case Kernel::Sse2:
+      return &convertSse2;
+    case Kernel::Avx2:
+      return &convertAvx2;
+    case Kernel::Bmi2:
+      if constexpr (sizeof(T) > 1) {
+        return &convertBmi2;
+      }
+      break;
+#endif
+    default:
+      break;
+  }
+
+  return &convertScalar<T>;
+}
+
+template class PixelConverter<Sample>;
+template class PixelConverter<WideSample>;
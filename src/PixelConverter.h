@@ -0,0 +1,60 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "SdlWrapper.h"
+#include "VisualizerConfiguration.h"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Lookup tables built once from the configuration
+struct PixelLookupTable {
+  std::vector<Pixel> pixels; // indexed by the bits of the used channels (see channelMask)
+  uint32_t channelMask = 0;  // channels taking part in the conversion
+  // Portable channel extraction for wide samples: index bits contributed by the lower/upper byte of a sample
+  std::array<uint32_t, 256> lowByteIndices = {};
+  std::array<uint32_t, 256> highByteIndices = {};
+};
+
+// Converts samples to pixels through a lookup table that is built once from the configuration.
+// 8 bit samples index the table directly. Wide samples would need a table with 65536 entries, so the used channels
+// are gathered into a compact index first (BMI2 PEXT or two byte-wise tables).
+// The conversion kernel is chosen at runtime depending on the instruction sets supported by the CPU.
+template <typename T>
+class PixelConverter final {
+public:
+  enum class Kernel {
+    Auto,
+    Scalar,
+    Sse2,
+    Avx2,
+    Bmi2, // wide samples only
+  };
+
+  explicit PixelConverter(const VisualizerConfiguration& config, Kernel kernel = Kernel::Auto);
+
+  // Convert samples.size() samples into pixels (pixels needs room for at least as many values)
+  auto convert(std::span<const T> samples, Pixel* pixels) const -> void {
+    convertFunction(lookupTable, samples, pixels);
+  }
+
+  [[nodiscard]] auto getKernel() const -> Kernel {
+    return mKernel;
+  }
+
+  [[nodiscard]] static auto isSupported(Kernel kernel) -> bool;
+  [[nodiscard]] static auto getKernelName(Kernel kernel) -> std::string;
+
+private:
+  using ConvertFunction = void (*)(const PixelLookupTable&, std::span<const T>, Pixel*);
+
+  static auto buildLookupTable(const VisualizerConfiguration& config) -> PixelLookupTable;
+  static auto selectKernel(Kernel kernel) -> Kernel;
+  static auto getConvertFunction(Kernel kernel) -> ConvertFunction;
+
+  const PixelLookupTable lookupTable;
+  const Kernel mKernel;
+  const ConvertFunction convertFunction;
+};
@@ -0,0 +1,69 @@
+#include "PlaybackClock.h"
+#include <algorithm>
+
+PlaybackClock::PlaybackClock(uint64_t sampleRate)
+  : mSampleRate(std::max<uint64_t>(sampleRate, 1)),
+    baseTime(std::chrono::steady_clock::now()) {
+}
+
+auto PlaybackClock::reset(uint64_t position) -> void {
+  std::lock_guard lock(mutex);
+  baseTime = std::chrono::steady_clock::now();
+  basePosition = position;
+  generation++;
+  changed.notify_all();
+}
+
+auto PlaybackClock::setSpeed(double newSpeed) -> void {
+  std::lock_guard lock(mutex);
+  const auto now = std::chrono::steady_clock::now();
+  basePosition = positionAt(now);
+  baseTime = now;
+  speed = std::clamp(newSpeed, MIN_SPEED, MAX_SPEED);
+  generation++;
+  changed.notify_all();
+}
+
+auto PlaybackClock::setUnthrottled(bool newUnthrottled) -> void {
+  std::lock_guard lock(mutex);
+  unthrottled = newUnthrottled;
+  generation++;
+  changed.notify_all();
+}
+
+auto PlaybackClock::waitUntil(uint64_t position) -> void {
+  std::unique_lock lock(mutex);
+  if (unthrottled) {
+    // Keep the clock up to date so throttling continues from here
+    baseTime = std::chrono::steady_clock::now();
+    basePosition = position;
+    return;
+  }
+  if (position <= basePosition) {
+    return;
+  }
+  const auto dueTime = baseTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(static_cast<double>(position - basePosition) / (static_cast<double>(mSampleRate) * speed)));
+  const auto startGeneration = generation;
+  changed.wait_until(lock, dueTime, [this, startGeneration] { return generation != startGeneration; });
+}
+
+auto PlaybackClock::interrupt() -> void {
+  std::lock_guard lock(mutex);
+  generation++;
+  changed.notify_all();
+}
+
+auto PlaybackClock::getSpeed() const -> double {
+  std::lock_guard lock(mutex);
+  return speed;
+}
+
+auto PlaybackClock::isUnthrottled() const -> bool {
+  std::lock_guard lock(mutex);
+  return unthrottled;
+}
+
+auto PlaybackClock::positionAt(std::chrono::steady_clock::time_point time) const -> uint64_t {
+  const auto elapsed = std::chrono::duration<double>(time - baseTime).count();
+  return basePosition + static_cast<uint64_t>(std::max(0.0, elapsed) * static_cast<double>(mSampleRate) * speed);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Maps wall-clock time to the stream position that should have been decoded by now, so recorded sessions are played
+// in real time (or faster/slower). Speed changes and seeks rebase the clock instead of accumulating sleep errors.
+// Controlled by the presenter, waited on by the decoder thread.
+class PlaybackClock final {
+public:
+  explicit PlaybackClock(uint64_t sampleRate);
+
+  // Continue playback from the given stream position now
+  auto reset(uint64_t position) -> void;
+  auto setSpeed(double speed) -> void; // 1 = real time
+  auto setUnthrottled(bool unthrottled) -> void;
+
+  // Block until the position is due. Returns early when the clock is changed or interrupted meanwhile.
+  auto waitUntil(uint64_t position) -> void;
+  // Wake up a waiting decoder without changing the clock (e.g. to pause or stop)
+  auto interrupt() -> void;
+
+  [[nodiscard]] auto getSpeed() const -> double;
+  [[nodiscard]] auto isUnthrottled() const -> bool;
+
+  static constexpr double MIN_SPEED = 1.0 / 64;
+  static constexpr double MAX_SPEED = 64;
+
+private:
+  // Stream position due at the given time (mutex held)
+  [[nodiscard]] auto positionAt(std::chrono::steady_clock::time_point time) const -> uint64_t;
+
+  const uint64_t mSampleRate;
+  mutable std::mutex mutex;
+  std::condition_variable changed;
+  std::chrono::steady_clock::time_point baseTime;
+  uint64_t basePosition = 0;
+  double speed = 1;
+  bool unthrottled = false;
+  uint64_t generation = 0; // incremented on every change and interrupt
+};
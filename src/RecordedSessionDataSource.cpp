@@ -3,35 +3,44 @@
 #include <libsigrokcxx/libsigrokcxx.hpp>
 #include <stdexcept>
 
-RecordedSessionDataSource::RecordedSessionDataSource(
-  SampleDataDispatcher& dataDispatcher,
+template <typename T>
+RecordedSessionDataSource<T>::RecordedSessionDataSource(
+  DataDispatcher<T>& dataDispatcher,
   const DataSourceConfiguration& config
-) : DataSource(dataDispatcher, config) {
-  if (!mConfig.inputFile) {
+) : DataSource<T>(dataDispatcher, config) {
+  if (!this->mConfig.inputFile) {
     throw std::runtime_error("No input file was passed.");
   }
-  session = context->load_session(mConfig.inputFile.value());
+  this->session = this->context->load_session(this->mConfig.inputFile.value());
 
   try {
-    auto gvar = session->devices().at(0)->config_get(sigrok::ConfigKey::SAMPLERATE);
-    sampleRate = Glib::VariantBase::cast_dynamic<Glib::Variant<guint64>>(gvar).get();
+    auto gvar = this->session->devices().at(0)->config_get(sigrok::ConfigKey::SAMPLERATE);
+    this->sampleRate = Glib::VariantBase::cast_dynamic<Glib::Variant<guint64>>(gvar).get();
   } catch (sigrok::Error& error) {
     throw std::runtime_error("Unable to determine sample rate.");
   }
+
+  for (const auto& channel : this->session->devices().at(0)->channels()) {
+    this->channelNames.push_back(channel->name());
+  }
 }
 
-auto RecordedSessionDataSource::run() -> void {
+template <typename T>
+auto RecordedSessionDataSource<T>::run() -> void {
   try {
-    session->add_datafeed_callback([this](std::shared_ptr<sigrok::Device> device, std::shared_ptr<sigrok::Packet> packet) {
-      handlePacket(device, packet);
+    this->session->add_datafeed_callback([this](std::shared_ptr<sigrok::Device> device, std::shared_ptr<sigrok::Packet> packet) {
+      this->handlePacket(device, packet);
     });
 
-    while (!mDataDispatcher.isClosed()) {
-      session->start();
-      session->run(); // event loop, exited when session->stop() is called or end of data is reached
+    while (!this->mDataDispatcher.isClosed()) {
+      this->session->start();
+      this->session->run(); // event loop, exited when session->stop() is called or end of data is reached
     }
   } catch (std::exception& e) {
     std::cerr << "Exception in data source thread: " << e.what() << std::endl;
-    mDataDispatcher.close();
+    this->mDataDispatcher.close();
   }
 }
+
+template class RecordedSessionDataSource<Sample>;
+template class RecordedSessionDataSource<WideSample>;
@@ -3,10 +3,11 @@
 #include "DataDispatcher.h"
 #include "DataSource.h"
 
-class RecordedSessionDataSource final : public DataSource {
+template <typename T>
+class RecordedSessionDataSource final : public DataSource<T> {
 public:
   RecordedSessionDataSource(
-    SampleDataDispatcher& dataDispatcher,
+    DataDispatcher<T>& dataDispatcher,
     const DataSourceConfiguration& config
   );
   auto run() -> void override;
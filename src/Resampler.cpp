@@ -0,0 +1,114 @@
+#include "Resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+
+// Spreads the 4 components of a pixel into 16 bit lanes, so the whole samples of a pixel are summed with one
+// addition each (SWAR)
+inline auto spread(Pixel pixel) -> uint64_t {
+  uint64_t lanes = pixel;
+  lanes = (lanes | lanes << 16) & 0x0000ffff0000ffffULL;
+  lanes = (lanes | lanes << 8) & 0x00ff00ff00ff00ffULL;
+  return lanes;
+}
+
+} // namespace
+
+template <typename T>
+Resampler<T>::Resampler(int width, const PixelConverter<T>& pixelConverter)
+  : mWidth(width),
+    mPixelConverter(pixelConverter) {
+}
+
+template <typename T>
+auto Resampler<T>::startLine(uint32_t newStep) -> void {
+  step = newStep;
+  started = false;
+}
+
+// All samples are converted by the lookup table kernel first. The whole samples of a pixel are summed in 16 bit
+// lanes, only the (at most two) samples on its borders are weighted.
+template <typename T>
+auto Resampler<T>::convert(std::span<const T> samples, long int windowColumn, Pixel* line) -> void {
+  if (step == 0) {
+    return;
+  }
+  const auto column = static_cast<uint64_t>(windowColumn) << 16;
+  if (!started || position != column) {
+    position = column;
+    pixel = static_cast<long int>(position / step);
+    boundary = static_cast<uint64_t>(pixel + 1) * step;
+    sums = {};
+    started = true;
+  }
+  convertedPixels.resize(samples.size());
+  mPixelConverter.convert(samples, convertedPixels.data());
+
+  size_t i = 0;
+  while (i < convertedPixels.size() && pixel < mWidth) {
+    const auto whole = std::min(convertedPixels.size() - i, static_cast<size_t>((boundary - position) >> 16));
+    uint64_t lanes = 0;
+    for (const auto end = i + whole; i < end; i++) {
+      lanes += spread(convertedPixels[i]);
+    }
+    for (size_t component = 0; component < sums.size(); component++) {
+      sums[component] += ((lanes >> (component * 16)) & 0xffff) << 16;
+    }
+    position += static_cast<uint64_t>(whole) << 16;
+    if (position == boundary) {
+      emit(line);
+      continue;
+    }
+    if (i == convertedPixels.size()) {
+      break;
+    }
+
+    // Sample on the border, the rest of it belongs to the next pixel (a pixel covers at least one sample)
+    const auto covered = static_cast<uint32_t>(boundary - position);
+    const Pixel value = convertedPixels[i];
+    for (size_t component = 0; component < sums.size(); component++) {
+      sums[component] += static_cast<uint64_t>((value >> (component * 8)) & 0xff) * covered;
+    }
+    emit(line);
+    for (size_t component = 0; component < sums.size(); component++) {
+      sums[component] += static_cast<uint64_t>((value >> (component * 8)) & 0xff) * (ONE - covered);
+    }
+    position += ONE;
+    i++;
+  }
+}
+
+template <typename T>
+auto Resampler<T>::getWindowLength() const -> long int {
+  return static_cast<long int>((static_cast<uint64_t>(mWidth) * step + ONE - 1) >> 16);
+}
+
+template <typename T>
+auto Resampler<T>::getStep(double linePeriod, unsigned int linePixels) -> uint32_t {
+  if (linePeriod <= 0 || linePixels == 0) {
+    return 0;
+  }
+  const auto step = std::llround(linePeriod * ONE / linePixels);
+
+  return static_cast<uint32_t>(std::clamp(step, static_cast<long long>(ONE), static_cast<long long>(MAX_STEP)));
+}
+
+// Sums are weighted by the fixed-point coverage, which adds up to the step
+template <typename T>
+auto Resampler<T>::emit(Pixel* line) -> void {
+  if (pixel >= 0 && pixel < mWidth) {
+    Pixel result = 0;
+    for (size_t component = 0; component < sums.size(); component++) {
+      result |= static_cast<Pixel>(std::min<uint64_t>((sums[component] + step / 2) / step, 0xff)) << (component * 8);
+    }
+    line[pixel] = result;
+  }
+  pixel++;
+  boundary += step;
+  sums = {};
+}
+
+template class Resampler<Sample>;
+template class Resampler<WideSample>;
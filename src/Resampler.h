@@ -0,0 +1,47 @@
+#pragma once
+
+#include "PixelConverter.h"
+#include "SdlWrapper.h"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Horizontal resampling to a fixed number of pixels per line, independent of the sample rate: the line period is
+// mapped onto the pixels with a 16.16 fixed-point step, so a pixel may cover a fractional number of samples.
+// Each pixel is the area average of the converted samples it covers, samples on a pixel border contribute to both
+// pixels by the covered fraction. Only reduces: a pixel covers 1 to MAX_STEP samples.
+template <typename T>
+class Resampler final {
+public:
+  static constexpr uint32_t ONE = 1 << 16;        // one sample in fixed point
+  static constexpr uint32_t MAX_STEP = 256 * ONE; // component sums of whole samples fit into 16 bits
+
+  Resampler(int width, const PixelConverter<T>& pixelConverter);
+
+  // Starts a line with the given fixed-point step (samples per pixel, 0 when the line period is not known yet)
+  auto startLine(uint32_t step) -> void;
+
+  // Samples continue the line at windowColumn (samples from the left of the window). Pixels are written to line
+  // as soon as they are complete.
+  auto convert(std::span<const T> samples, long int windowColumn, Pixel* line) -> void;
+
+  // Samples covered by the width
+  [[nodiscard]] auto getWindowLength() const -> long int;
+
+  [[nodiscard]] static auto getStep(double linePeriod, unsigned int linePixels) -> uint32_t;
+
+private:
+  inline auto emit(Pixel* line) -> void;
+
+  const int mWidth;
+  const PixelConverter<T>& mPixelConverter;
+
+  std::vector<Pixel> convertedPixels; // scratch buffer, capacity is reused
+  uint32_t step = 0;
+  uint64_t position = 0; // fixed-point window column of the next sample
+  uint64_t boundary = 0; // fixed-point window column where the current pixel ends
+  long int pixel = 0;
+  bool started = false;
+  std::array<uint64_t, 4> sums = {}; // per color component of the current pixel, weighted by fixed-point coverage
+};
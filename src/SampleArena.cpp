@@ -0,0 +1,158 @@
+#include "SampleArena.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+auto roundUp(size_t value, size_t multiple) -> size_t {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+template <typename T>
+SampleArena<T>::Slice::Slice(Block* acquiredBlock)
+  : block(acquiredBlock) {
+  block->references.store(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+SampleArena<T>::Slice::Slice(const Slice& other)
+  : block(other.block),
+    size(other.size) {
+  if (block) {
+    block->references.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+SampleArena<T>::Slice::Slice(Slice&& other) noexcept
+  : block(std::exchange(other.block, nullptr)),
+    size(std::exchange(other.size, 0)) {
+}
+
+template <typename T>
+SampleArena<T>::Slice::~Slice() {
+  if (block && block->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    block->arena->release(block);
+  }
+}
+
+template <typename T>
+auto SampleArena<T>::Slice::operator=(const Slice& other) -> Slice& {
+  Slice copy(other);
+  std::swap(block, copy.block);
+  std::swap(size, copy.size);
+  return *this;
+}
+
+template <typename T>
+auto SampleArena<T>::Slice::operator=(Slice&& other) noexcept -> Slice& {
+  Slice moved(std::move(other));
+  std::swap(block, moved.block);
+  std::swap(size, moved.size);
+  return *this;
+}
+
+template <typename T>
+auto SampleArena<T>::Slice::getData() const -> T* {
+  return block ? block->data : nullptr;
+}
+
+template <typename T>
+auto SampleArena<T>::Slice::getSamples() const -> std::span<T> {
+  return std::span<T>(getData(), size);
+}
+
+template <typename T>
+auto SampleArena<T>::Slice::getCapacity() const -> size_t {
+  return block ? block->arena->getBlockCapacity() : 0;
+}
+
+template <typename T>
+auto SampleArena<T>::Slice::setSize(size_t newSize) -> void {
+  size = newSize;
+}
+
+template <typename T>
+SampleArena<T>::SampleArena(
+  size_t blockBytes,
+  size_t blocksPerChunk,
+  bool hugePages
+) : blockSize(roundUp(std::max(blockBytes, sizeof(T)), static_cast<size_t>(sysconf(_SC_PAGESIZE)))),
+    blockCapacity(blockSize / sizeof(T)),
+    mBlocksPerChunk(std::max<size_t>(blocksPerChunk, 1)),
+    mHugePages(hugePages) {
+  std::lock_guard lk(freeListMutex);
+  allocateChunk();
+}
+
+template <typename T>
+SampleArena<T>::~SampleArena() {
+  for (const auto& chunk : chunks) {
+    munmap(chunk.memory, chunk.size);
+  }
+}
+
+template <typename T>
+auto SampleArena<T>::acquire() -> Slice {
+  std::lock_guard lk(freeListMutex);
+  if (!freeList) {
+    allocateChunk();
+  }
+  Block* block = freeList;
+  freeList = block->nextFree;
+
+  return Slice(block);
+}
+
+// Huge pages have to be reserved by the administrator. Without them, the kernel is at least asked to back the chunk
+// with transparent huge pages.
+template <typename T>
+auto SampleArena<T>::allocateChunk() -> void {
+  Chunk chunk;
+  chunk.size = blockSize * mBlocksPerChunk;
+  chunk.memory = MAP_FAILED;
+  if (mHugePages) {
+    chunk.size = roundUp(chunk.size, HUGE_PAGE_SIZE);
+    chunk.memory = mmap(nullptr, chunk.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+  if (chunk.memory == MAP_FAILED) {
+    chunk.memory = mmap(nullptr, chunk.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (chunk.memory == MAP_FAILED) {
+      throw std::runtime_error(std::string("Unable to allocate sample buffers: ") + std::strerror(errno));
+    }
+    if (mHugePages) {
+      madvise(chunk.memory, chunk.size, MADV_HUGEPAGE);
+    }
+  }
+
+  const auto blockCount = chunk.size / blockSize;
+  chunk.blocks = std::make_unique<Block[]>(blockCount);
+  for (size_t i = 0; i < blockCount; i++) {
+    auto& block = chunk.blocks[i];
+    block.arena = this;
+    block.data = reinterpret_cast<T*>(static_cast<uint8_t*>(chunk.memory) + i * blockSize);
+    block.nextFree = freeList;
+    freeList = &block;
+  }
+  allocatedBytes.fetch_add(chunk.size, std::memory_order_relaxed);
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  chunks.push_back(std::move(chunk));
+}
+
+template <typename T>
+auto SampleArena<T>::release(Block* block) -> void {
+  std::lock_guard lk(freeListMutex);
+  block->nextFree = freeList;
+  freeList = block;
+}
+
+template class SampleArena<uint8_t>;
+template class SampleArena<uint16_t>;
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+// Page-aligned buffers for the samples on their way from the data source to the decoder. The memory is mapped in
+// chunks of equally sized blocks (optionally on huge pages), which are handed out as reference-counted slices and
+// return to a free list when the last reference is gone. Once warmed up, nothing is allocated: a new chunk is only
+// mapped when all blocks are in use (counted, see getAllocationCount()).
+// Slices may be held by any thread, but must not outlive the arena.
+template <typename T>
+class SampleArena final {
+private:
+  struct Block;
+
+public:
+  // Reference to a block and the number of samples in it. Copies share the block.
+  class Slice final {
+  public:
+    Slice() = default;
+    Slice(const Slice& other);
+    Slice(Slice&& other) noexcept;
+    ~Slice();
+    auto operator=(const Slice& other) -> Slice&;
+    auto operator=(Slice&& other) noexcept -> Slice&;
+
+    explicit operator bool() const {
+      return block != nullptr;
+    }
+    // Start of the block, to be filled by the producer before it is passed on
+    [[nodiscard]] auto getData() const -> T*;
+    [[nodiscard]] auto getSamples() const -> std::span<T>;
+    [[nodiscard]] auto getSize() const -> size_t {
+      return size;
+    }
+    [[nodiscard]] auto getCapacity() const -> size_t;
+    auto setSize(size_t newSize) -> void;
+
+  private:
+    friend class SampleArena;
+    explicit Slice(Block* acquiredBlock);
+
+    Block* block = nullptr;
+    size_t size = 0;
+  };
+
+  SampleArena(
+    size_t blockBytes = DEFAULT_BLOCK_BYTES,
+    size_t blocksPerChunk = DEFAULT_BLOCKS_PER_CHUNK,
+    bool hugePages = false
+  );
+  ~SampleArena();
+  SampleArena(const SampleArena&) = delete;
+  auto operator=(const SampleArena&) -> SampleArena& = delete;
+
+  // Empty slice of a free block (getCapacity() samples)
+  [[nodiscard]] auto acquire() -> Slice;
+
+  [[nodiscard]] auto getBlockCapacity() const -> size_t {
+    return blockCapacity;
+  }
+  // Number of chunks mapped so far (the first one included)
+  [[nodiscard]] auto getAllocationCount() const -> uint64_t {
+    return allocationCount.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] auto getAllocatedBytes() const -> uint64_t {
+    return allocatedBytes.load(std::memory_order_relaxed);
+  }
+
+  static constexpr size_t DEFAULT_BLOCK_BYTES = 64 * 1024;
+  static constexpr size_t DEFAULT_BLOCKS_PER_CHUNK = 16;
+
+private:
+  struct Block {
+    SampleArena* arena = nullptr;
+    T* data = nullptr;
+    std::atomic<uint32_t> references = 0;
+    Block* nextFree = nullptr;
+  };
+
+  struct Chunk {
+    void* memory = nullptr;
+    size_t size = 0;
+    std::unique_ptr<Block[]> blocks;
+  };
+
+  auto allocateChunk() -> void;
+  auto release(Block* block) -> void;
+
+  const size_t blockSize; // bytes, multiple of the page size
+  const size_t blockCapacity;
+  const size_t mBlocksPerChunk;
+  const bool mHugePages;
+
+  std::mutex freeListMutex; // only held to pop or push a block (or to map a chunk)
+  Block* freeList = nullptr;
+  std::vector<Chunk> chunks;
+  std::atomic<uint64_t> allocationCount = 0;
+  std::atomic<uint64_t> allocatedBytes = 0;
+
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+};
@@ -0,0 +1,156 @@
+#include "SamplePyramid.h"
+#include <algorithm>
+#include <array>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+template <typename Summary>
+auto combine(Summary& summary, const Summary& other) -> void {
+  summary.any |= other.any;
+  summary.all &= other.all;
+}
+
+} // namespace
+
+template <typename T>
+SamplePyramid<T>::SamplePyramid(std::span<const T> samples)
+  : mSamples(samples) {
+  const auto blockCount = mSamples.size() / BLOCK_SIZE;
+  if (blockCount == 0) {
+    return;
+  }
+  levels.emplace_back(blockCount);
+  for (size_t i = 0; i < blockCount; i++) {
+    levels[0][i] = summarizeSamples(mSamples.subspan(i * BLOCK_SIZE, BLOCK_SIZE));
+  }
+  while (levels.back().size() >= FAN_OUT) {
+    const auto& lower = levels.back();
+    std::vector<Summary> level(lower.size() / FAN_OUT);
+    for (size_t i = 0; i < level.size(); i++) {
+      for (size_t j = 0; j < FAN_OUT; j++) {
+        combine(level[i], lower[i * FAN_OUT + j]);
+      }
+    }
+    levels.push_back(std::move(level));
+  }
+}
+
+// Whole entries are taken from the highest level that fits, the samples before the first and after the last complete
+// block are looked at directly.
+template <typename T>
+auto SamplePyramid<T>::summarize(uint64_t begin, uint64_t end) const -> Summary {
+  end = std::min<uint64_t>(end, mSamples.size());
+  Summary summary;
+  uint64_t position = begin;
+  while (position < end) {
+    if (levels.empty() || position % BLOCK_SIZE != 0 || position + BLOCK_SIZE > end || position / BLOCK_SIZE >= levels[0].size()) {
+      const auto next = std::min(end, (position / BLOCK_SIZE + 1) * BLOCK_SIZE);
+      combine(summary, summarizeSamples(mSamples.subspan(position, next - position)));
+      position = next;
+      continue;
+    }
+    size_t level = 0;
+    while (level + 1 < levels.size()) {
+      const auto span = getSpan(level + 1);
+      if (position % span != 0 || position + span > end || position / span >= levels[level + 1].size()) {
+        break;
+      }
+      level++;
+    }
+    combine(summary, levels[level][position / getSpan(level)]);
+    position += getSpan(level);
+  }
+
+  return summary;
+}
+
+template <typename T>
+auto SamplePyramid<T>::findChange(uint64_t begin, uint64_t end, T mask, T reference) const -> uint64_t {
+  end = std::min<uint64_t>(end, mSamples.size());
+  const T expected = static_cast<T>(reference & mask);
+  const auto uniform = [mask, expected](const Summary& summary) {
+    return (summary.any & mask) == expected && (summary.all & mask) == expected;
+  };
+  const auto scan = [this, mask, expected](uint64_t from, uint64_t to) {
+    for (; from < to; from++) {
+      if ((mSamples[from] & mask) != expected) {
+        break;
+      }
+    }
+    return from;
+  };
+
+  uint64_t position = begin;
+  while (position < end) {
+    if (levels.empty() || position % BLOCK_SIZE != 0 || position / BLOCK_SIZE >= levels[0].size() || !uniform(levels[0][position / BLOCK_SIZE])) {
+      const auto next = std::min(end, (position / BLOCK_SIZE + 1) * BLOCK_SIZE);
+      position = scan(position, next);
+      if (position < next) {
+        return position;
+      }
+      continue;
+    }
+    // Skip the largest uniform entry starting here
+    size_t level = 0;
+    while (level + 1 < levels.size()) {
+      const auto span = getSpan(level + 1);
+      if (position % span != 0 || position / span >= levels[level + 1].size() || !uniform(levels[level + 1][position / span])) {
+        break;
+      }
+      level++;
+    }
+    position += getSpan(level);
+  }
+
+  return end;
+}
+
+template <typename T>
+auto SamplePyramid<T>::summarizeSamples(std::span<const T> samples) -> Summary {
+  Summary summary;
+  size_t i = 0;
+
+#ifdef __SSE2__
+  constexpr size_t lanes = 16 / sizeof(T);
+  if (samples.size() >= lanes) {
+    __m128i any = _mm_setzero_si128();
+    __m128i all = _mm_set1_epi32(-1);
+    for (; i + lanes <= samples.size(); i += lanes) {
+      const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+      any = _mm_or_si128(any, values);
+      all = _mm_and_si128(all, values);
+    }
+    std::array<T, lanes> anyLanes;
+    std::array<T, lanes> allLanes;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(anyLanes.data()), any);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(allLanes.data()), all);
+    for (size_t lane = 0; lane < lanes; lane++) {
+      summary.any |= anyLanes[lane];
+      summary.all &= allLanes[lane];
+    }
+  }
+#endif
+
+  for (const T sample : samples.subspan(i)) {
+    summary.any |= sample;
+    summary.all &= sample;
+  }
+
+  return summary;
+}
+
+template <typename T>
+auto SamplePyramid<T>::getSpan(size_t level) -> uint64_t {
+  uint64_t span = BLOCK_SIZE;
+  for (size_t i = 0; i < level; i++) {
+    span *= FAN_OUT;
+  }
+  return span;
+}
+
+template class SamplePyramid<Sample>;
+template class SamplePyramid<WideSample>;
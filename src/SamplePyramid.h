@@ -0,0 +1,43 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Multi-resolution summary of a recorded capture, like a mipmap: level 0 summarizes blocks of BLOCK_SIZE samples,
+// every further level FAN_OUT entries of the level below. Each entry holds which channels are set in any and in all of
+// its samples (the maximum and minimum per channel). Ranges of any length are summarized by looking at O(levels)
+// entries plus the samples at their ends, and channel changes are found by skipping over uniform entries, so views of
+// huge captures don't have to touch every sample.
+// T is the sample type (Sample or WideSample).
+template <typename T>
+class SamplePyramid final {
+public:
+  struct Summary {
+    T any = 0;                   // channels set in at least one sample
+    T all = static_cast<T>(~0U); // channels set in every sample
+  };
+
+  explicit SamplePyramid(std::span<const T> samples);
+
+  // Summary of the samples [begin, end)
+  [[nodiscard]] auto summarize(uint64_t begin, uint64_t end) const -> Summary;
+  // First position in [begin, end) whose channels of mask differ from those of reference, end if there is none
+  [[nodiscard]] auto findChange(uint64_t begin, uint64_t end, T mask, T reference) const -> uint64_t;
+
+  [[nodiscard]] auto getLevelCount() const -> size_t {
+    return levels.size();
+  }
+
+  static constexpr uint64_t BLOCK_SIZE = 256; // samples per entry of level 0
+  static constexpr uint64_t FAN_OUT = 16;     // entries per entry of the next level
+
+private:
+  [[nodiscard]] static auto summarizeSamples(std::span<const T> samples) -> Summary;
+  [[nodiscard]] static auto getSpan(size_t level) -> uint64_t; // samples per entry
+
+  const std::span<const T> mSamples;
+  std::vector<std::vector<Summary>> levels; // only complete blocks
+};
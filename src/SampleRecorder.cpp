@@ -0,0 +1,27 @@
+#include "SampleRecorder.h"
+#include <chrono>
+
+template <typename T>
+SampleRecorder<T>::SampleRecorder(
+  DataDispatcher<T>& dataDispatcher,
+  NativeCaptureWriter<T>& writer
+) : mDataDispatcher(dataDispatcher),
+    mWriter(writer) {
+}
+
+template <typename T>
+auto SampleRecorder<T>::run() -> void {
+  while (true) {
+    auto optionalData = mDataDispatcher.get(std::chrono::milliseconds(250));
+    if (optionalData) {
+      mWriter.write(optionalData.value());
+      mDataDispatcher.clear();
+    } else if (mDataDispatcher.isClosed()) {
+      break;
+    }
+  }
+  mWriter.finish();
+}
+
+template class SampleRecorder<Sample>;
+template class SampleRecorder<WideSample>;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "NativeCaptureWriter.h"
+
+// Consumer that drains a dispatcher into a native capture file.
+template <typename T>
+class SampleRecorder final {
+public:
+  SampleRecorder(
+    DataDispatcher<T>& dataDispatcher,
+    NativeCaptureWriter<T>& writer
+  );
+
+  // Main loop: Writes samples until the producer closes the channel.
+  auto run() -> void;
+
+private:
+  DataDispatcher<T>& mDataDispatcher;
+  NativeCaptureWriter<T>& mWriter;
+};
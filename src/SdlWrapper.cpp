@@ -1,8 +1,29 @@
 #include "SdlWrapper.h"
 #include "SDL_video.h"
+#include <algorithm>
+#include <array>
 #include <stdexcept>
+#include <string_view>
 
-SdlWrapper::SdlWrapper(int width, int height, const std::string& windowTitle) {
+namespace {
+
+// 3x5 pixel font for the overlay, one bit per pixel (row by row, most significant bit is top left)
+constexpr std::string_view FONT_CHARACTERS = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ./:-";
+constexpr std::array<uint16_t, FONT_CHARACTERS.size()> FONT_GLYPHS = {
+  0b111101101101111, 0b010110010010111, 0b111001111100111, 0b111001111001111, 0b101101111001001, 0b111100111001111, 0b111100111101111, 0b111001001001001,
+  0b111101111101111, 0b111101111001111, 0b010101111101101, 0b110101110101110, 0b011100100100011, 0b110101101101110, 0b111100110100111, 0b111100110100100,
+  0b011100101101011, 0b101101111101101, 0b111010010010111, 0b001001001101010, 0b101101110101101, 0b100100100100111, 0b101111111101101, 0b110101101101101,
+  0b010101101101010, 0b110101110100100, 0b010101101110011, 0b110101110101101, 0b011100010001110, 0b111010010010010, 0b101101101101111, 0b101101101101010,
+  0b101101111111101, 0b101101010101101, 0b101101010010010, 0b111001010100111, 0b000000000000010, 0b001001010100100, 0b000010000010000, 0b000000111000000,
+};
+constexpr int GLYPH_WIDTH = 3;
+constexpr int GLYPH_HEIGHT = 5;
+constexpr int FONT_SCALE = 2;
+constexpr int OVERLAY_MARGIN = 4;
+
+} // namespace
+
+SdlWrapper::SdlWrapper(int width, int height, const std::string& windowTitle) : mWidth(width) {
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) < 0) {
     throw std::runtime_error("Unable to initialize SDL" + std::string(SDL_GetError()));
   }
@@ -47,29 +68,101 @@ SdlWrapper::~SdlWrapper() {
   SDL_Quit();
 }
 
-auto SdlWrapper::quitEventOccured() -> bool {
+auto SdlWrapper::pollEvents() -> SdlEvents {
   SDL_Event event;
-  bool quit = false;
+  SdlEvents events;
   while (SDL_PollEvent(&event)) {
     if (event.type == SDL_QUIT) {
-      quit = true;
+      events.quit = true;
+    } else if (event.type == SDL_KEYDOWN) {
+      events.pressedKeys.push_back(event.key.keysym.sym);
     }
   }
 
-  return quit;
+  return events;
 }
 
-auto SdlWrapper::lockTexture(Pixel** pixels) -> void {
-  int pitch;
-  SDL_LockTexture(texture, NULL, (void**)pixels, &pitch);
+auto SdlWrapper::updateTexture(std::span<const Pixel> pixels) -> void {
+  SDL_UpdateTexture(texture, NULL, pixels.data(), mWidth * static_cast<int>(sizeof(Pixel)));
 }
 
-auto SdlWrapper::unlockTexture() -> void {
-  SDL_UnlockTexture(texture);
+// Horizontally adjacent dirty tiles are uploaded as one rectangle
+auto SdlWrapper::updateTexture(const SDL_Rect& area, std::span<const Pixel> pixels, std::span<const uint8_t> dirtyTiles, int tileSize) -> void {
+  const int tileColumns = (area.w + tileSize - 1) / tileSize;
+  const int pitch = area.w * static_cast<int>(sizeof(Pixel));
+  if (std::all_of(dirtyTiles.begin(), dirtyTiles.end(), [](uint8_t dirty) { return dirty; })) {
+    SDL_UpdateTexture(texture, &area, pixels.data(), pitch);
+    return;
+  }
+
+  for (size_t rowStart = 0; rowStart < dirtyTiles.size(); rowStart += static_cast<size_t>(tileColumns)) {
+    const int y = static_cast<int>(rowStart / static_cast<size_t>(tileColumns)) * tileSize;
+    int column = 0;
+    while (column < tileColumns) {
+      if (!dirtyTiles[rowStart + static_cast<size_t>(column)]) {
+        column++;
+        continue;
+      }
+      const int first = column;
+      while (column < tileColumns && dirtyTiles[rowStart + static_cast<size_t>(column)]) {
+        column++;
+      }
+      const int x = first * tileSize;
+      const SDL_Rect rect = {area.x + x, area.y + y, std::min(column * tileSize, area.w) - x, std::min(tileSize, area.h - y)};
+      SDL_UpdateTexture(texture, &rect, pixels.data() + static_cast<size_t>(y) * static_cast<size_t>(area.w) + static_cast<size_t>(x), pitch);
+    }
+  }
 }
 
-auto SdlWrapper::render() -> void {
+auto SdlWrapper::render(const std::vector<std::string>& overlayText) -> void {
   SDL_RenderClear(renderer);
   SDL_RenderCopy(renderer, texture, NULL, NULL);
+  if (!overlayText.empty()) {
+    drawOverlay(overlayText);
+  }
   SDL_RenderPresent(renderer);
 }
+
+auto SdlWrapper::setTitle(const std::string& title) -> void {
+  SDL_SetWindowTitle(window, title.c_str());
+}
+
+// Text is drawn as filled rectangles (one per glyph pixel) in window coordinates, so no font library is needed.
+auto SdlWrapper::drawOverlay(const std::vector<std::string>& lines) -> void {
+  const int lineHeight = (GLYPH_HEIGHT + 2) * FONT_SCALE;
+  const int characterWidth = (GLYPH_WIDTH + 1) * FONT_SCALE;
+
+  size_t longestLine = 0;
+  for (const auto& line : lines) {
+    longestLine = std::max(longestLine, line.size());
+  }
+  const SDL_Rect background = {0, 0, static_cast<int>(longestLine) * characterWidth + 2 * OVERLAY_MARGIN, static_cast<int>(lines.size()) * lineHeight + 2 * OVERLAY_MARGIN};
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 192);
+  SDL_RenderFillRect(renderer, &background);
+
+  overlayRects.clear();
+  for (size_t row = 0; row < lines.size(); row++) {
+    for (size_t column = 0; column < lines[row].size(); column++) {
+      const auto index = FONT_CHARACTERS.find(lines[row][column]);
+      if (index == std::string_view::npos) {
+        continue; // space or unsupported character
+      }
+      const auto glyph = FONT_GLYPHS[index];
+      for (int bit = 0; bit < GLYPH_WIDTH * GLYPH_HEIGHT; bit++) {
+        if (glyph & (1 << (GLYPH_WIDTH * GLYPH_HEIGHT - 1 - bit))) {
+          overlayRects.push_back({
+            OVERLAY_MARGIN + static_cast<int>(column) * characterWidth + (bit % GLYPH_WIDTH) * FONT_SCALE,
+            OVERLAY_MARGIN + static_cast<int>(row) * lineHeight + (bit / GLYPH_WIDTH) * FONT_SCALE,
+            FONT_SCALE,
+            FONT_SCALE,
+          });
+        }
+      }
+    }
+  }
+  SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+  SDL_RenderFillRects(renderer, overlayRects.data(), static_cast<int>(overlayRects.size()));
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
@@ -2,22 +2,38 @@
 
 #include <SDL2/SDL.h>
 #include <cstdint>
+#include <span>
 #include <string>
+#include <vector>
 
 using Pixel = uint32_t;
 
+// Input collected since the last call of pollEvents()
+struct SdlEvents {
+  bool quit = false;
+  std::vector<SDL_Keycode> pressedKeys;
+};
+
 class SdlWrapper final {
 public:
   SdlWrapper(int width, int height, const std::string& windowTitle);
   ~SdlWrapper();
 
-  auto quitEventOccured() -> bool;
-  auto lockTexture(Pixel** pixels) -> void;
-  auto unlockTexture() -> void;
-  auto render() -> void;
+  auto pollEvents() -> SdlEvents;
+  auto updateTexture(std::span<const Pixel> pixels) -> void;
+  // Upload a frame of area.w * area.h pixels into a part of the texture, but only the given tiles of it
+  // (one entry per tile, row by row, non-zero when changed)
+  auto updateTexture(const SDL_Rect& area, std::span<const Pixel> pixels, std::span<const uint8_t> dirtyTiles, int tileSize) -> void;
+  // Draw texture and (optionally) lines of text on top of it. The text may contain digits, capital letters, spaces and ./:-
+  auto render(const std::vector<std::string>& overlayText = {}) -> void;
+  auto setTitle(const std::string& title) -> void;
 
 private:
+  auto drawOverlay(const std::vector<std::string>& lines) -> void;
+
   SDL_Window* window;
   SDL_Renderer* renderer;
   SDL_Texture* texture;
+  const int mWidth;
+  std::vector<SDL_Rect> overlayRects; // reused between frames
 };
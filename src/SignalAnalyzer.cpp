@@ -0,0 +1,266 @@
+#include "SignalAnalyzer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+template <typename T>
+auto getDataChannelMask(const VisualizerConfiguration& config) -> T {
+  T mask = 0;
+  for (int bit = 0; bit < config.colorDepth; bit++) {
+    mask |= static_cast<T>(1 << (config.dataRedChannel - bit));
+    mask |= static_cast<T>(1 << (config.dataGreenChannel - bit));
+    mask |= static_cast<T>(1 << (config.dataBlueChannel - bit));
+  }
+  return mask;
+}
+
+} // namespace
+
+template <typename T>
+SignalAnalyzer<T>::SignalAnalyzer(
+  DataDispatcher<T>& dataDispatcher,
+  const VisualizerConfiguration& config,
+  const std::vector<uint8_t>& channels,
+  AnalysisFormat format,
+  const std::string& outputPath
+) : mDataDispatcher(dataDispatcher),
+    mConfig(config),
+    mChannels(channels),
+    mFormat(format),
+    vSyncChannelMask(static_cast<T>(1 << mConfig.vSyncChannel)),
+    hSyncChannelMask(static_cast<T>(1 << mConfig.hSyncChannel)),
+    dataChannelMask(getDataChannelMask<T>(mConfig)),
+    transitionDecoder(static_cast<T>((mConfig.compositeSync ? hSyncChannelMask : vSyncChannelMask | hSyncChannelMask) | dataChannelMask)) {
+  if (outputPath == "-") {
+    output = &std::cout;
+  } else {
+    fileStream = std::make_unique<std::ofstream>(outputPath);
+    if (!*fileStream) {
+      throw std::runtime_error("Unable to open output file " + outputPath);
+    }
+    output = fileStream.get();
+  }
+  *output << std::setprecision(9);
+  writeHeader();
+}
+
+template <typename T>
+auto SignalAnalyzer<T>::run() -> void {
+  while (true) {
+    auto optionalData = mDataDispatcher.get(std::chrono::milliseconds(250));
+    if (optionalData) {
+      skipGap(mDataDispatcher.getGap());
+      analyze(optionalData.value());
+      mDataDispatcher.clear();
+    } else if (mDataDispatcher.isClosed()) {
+      break;
+    }
+  }
+  output->flush();
+}
+
+template <typename T>
+auto SignalAnalyzer<T>::getFrameCount() const -> uint64_t {
+  return frameCount;
+}
+
+// Sync edges are handled per run; the channel counts of all samples between two frame starts are taken in one go.
+template <typename T>
+auto SignalAnalyzer<T>::analyze(std::span<const T> samples) -> void {
+  size_t offset = 0;
+  size_t frameOffset = 0; // first sample of the current frame in this block
+  for (const auto& run : transitionDecoder.decode(samples)) {
+    const T sample = run.value;
+    bool vSyncActive = mConfig.invertVSync == static_cast<bool>(sample & vSyncChannelMask);
+    bool hSyncActive = mConfig.invertHSync == static_cast<bool>(sample & hSyncChannelMask);
+    if (mConfig.compositeSync) {
+      const auto separated = compositeSyncSeparator.separate(hSyncActive, run.length);
+      vSyncActive = separated.vSyncActive;
+      hSyncActive = separated.hSyncActive;
+    }
+    if (afterGap) {
+      previousHSyncActive = hSyncActive;
+      previousVSyncActive = vSyncActive;
+      hSyncStartKnown = !hSyncActive;
+      vSyncStartKnown = !vSyncActive;
+      afterGap = false;
+    }
+
+    const T data = static_cast<T>(sample & dataChannelMask);
+    if (hasData && data != dataValue) {
+      frame.runLengthHistogram[std::min<uint64_t>(dataRunLength, MAX_RUN_LENGTH)]++;
+      dataRunLength = 0;
+    }
+    hasData = true;
+    dataValue = data;
+    dataRunLength += run.length;
+
+    if (!previousHSyncActive && hSyncActive) {
+      hSyncStart = position;
+      hSyncStartKnown = true;
+    } else if (previousHSyncActive && !hSyncActive && !mConfig.disableHSync) {
+      horizontalSyncEnded();
+    }
+    if (!previousVSyncActive && vSyncActive) {
+      vSyncStart = position;
+      vSyncStartKnown = true;
+    } else if (previousVSyncActive && !vSyncActive && !mConfig.disableVSync) {
+      channelCounter.count(samples.subspan(frameOffset, offset - frameOffset));
+      frameOffset = offset;
+      verticalSyncEnded();
+    }
+
+    previousHSyncActive = hSyncActive;
+    previousVSyncActive = vSyncActive;
+    offset += run.length;
+    position += run.length;
+  }
+  channelCounter.count(samples.subspan(frameOffset));
+}
+
+// Periods, pulses and data runs that started before the gap are not measured.
+template <typename T>
+auto SignalAnalyzer<T>::skipGap(const typename DataDispatcher<T>::Gap& gap) -> void {
+  if (gap.blockCount == 0) {
+    return;
+  }
+  frame.droppedBlocks += gap.blockCount;
+  frame.droppedSamples += gap.sampleCount;
+  position += gap.sampleCount;
+  afterGap = true;
+  hasLineStart = false;
+  previousLinePeriod = 0;
+  hasData = false;
+  dataRunLength = 0;
+  channelCounter.skipGap();
+}
+
+template <typename T>
+auto SignalAnalyzer<T>::horizontalSyncEnded() -> void {
+  if (hSyncStartKnown) {
+    frame.hSyncPulseCount++;
+    frame.hSyncWidthSum += position - hSyncStart;
+  }
+  if (hasLineStart) {
+    const auto period = position - lineStart;
+    frame.lineCount++;
+    frame.linePeriodSum += static_cast<double>(period);
+    frame.squaredLinePeriodSum += static_cast<double>(period) * static_cast<double>(period);
+    frame.minLinePeriod = frame.lineCount == 1 ? period : std::min(frame.minLinePeriod, period);
+    frame.maxLinePeriod = std::max(frame.maxLinePeriod, period);
+    if (previousLinePeriod > 0) {
+      const auto change = std::clamp(static_cast<long int>(period) - static_cast<long int>(previousLinePeriod), -JITTER_RANGE, JITTER_RANGE);
+      frame.jitterHistogram[static_cast<size_t>(change + JITTER_RANGE)]++;
+    }
+    previousLinePeriod = period;
+  }
+  hasLineStart = true;
+  lineStart = position;
+}
+
+template <typename T>
+auto SignalAnalyzer<T>::verticalSyncEnded() -> void {
+  if (frameStarted) {
+    writeFrame(position);
+    frameCount++;
+  }
+  frameStarted = true;
+  frame = FrameMetrics();
+  frame.start = position;
+  frame.vSyncWidth = vSyncStartKnown ? position - vSyncStart : 0;
+  channelCounter.reset();
+}
+
+template <typename T>
+auto SignalAnalyzer<T>::writeHeader() -> void {
+  if (mFormat != AnalysisFormat::Csv) {
+    return;
+  }
+  *output << "frame,start_s,frame_period,frame_rate_hz,lines,line_period,line_period_min,line_period_max,line_jitter,"
+          << "hsync_width,vsync_width,samples_per_pixel,pixel_clock_hz,dropped_blocks";
+  for (const auto channel : mChannels) {
+    *output << ",duty_cycle_" << static_cast<int>(channel) << ",edges_" << static_cast<int>(channel);
+  }
+  *output << "\n";
+}
+
+// Periods and widths are in samples, rates are only known with the sample rate (0 otherwise)
+template <typename T>
+auto SignalAnalyzer<T>::writeFrame(uint64_t end) -> void {
+  const auto sampleRate = static_cast<double>(mConfig.sampleRate);
+  const auto framePeriod = end - frame.start;
+  const auto lines = static_cast<double>(frame.lineCount);
+  const double linePeriod = frame.lineCount > 0 ? frame.linePeriodSum / lines : 0;
+  const double lineJitter = frame.lineCount > 0 ? std::sqrt(std::max(0.0, frame.squaredLinePeriodSum / lines - linePeriod * linePeriod)) : 0;
+  const double hSyncWidth = frame.hSyncPulseCount > 0 ? static_cast<double>(frame.hSyncWidthSum) / static_cast<double>(frame.hSyncPulseCount) : 0;
+  const double samplesPerPixel = estimateSamplesPerPixel();
+  const double pixelClock = samplesPerPixel > 0 ? sampleRate / samplesPerPixel : 0;
+  const double frameRate = framePeriod > 0 ? sampleRate / static_cast<double>(framePeriod) : 0;
+  const double dutyCycleDivisor = static_cast<double>(std::max<uint64_t>(framePeriod - frame.droppedSamples, 1)); // samples counted
+
+  auto& out = *output;
+  if (mFormat == AnalysisFormat::Csv) {
+    out << frameCount << "," << static_cast<double>(frame.start) / std::max(sampleRate, 1.0) << "," << framePeriod << "," << frameRate
+        << "," << frame.lineCount << "," << linePeriod << "," << frame.minLinePeriod << "," << frame.maxLinePeriod << "," << lineJitter
+        << "," << hSyncWidth << "," << frame.vSyncWidth << "," << samplesPerPixel << "," << pixelClock << "," << frame.droppedBlocks;
+    for (const auto channel : mChannels) {
+      out << "," << static_cast<double>(channelCounter.getHighCount(channel)) / dutyCycleDivisor << "," << channelCounter.getEdgeCount(channel);
+    }
+    out << "\n";
+    return;
+  }
+
+  out << "{\"frame\":" << frameCount
+      << ",\"start_s\":" << static_cast<double>(frame.start) / std::max(sampleRate, 1.0)
+      << ",\"frame_period\":" << framePeriod
+      << ",\"frame_rate_hz\":" << frameRate
+      << ",\"lines\":" << frame.lineCount
+      << ",\"line_period\":" << linePeriod
+      << ",\"line_period_min\":" << frame.minLinePeriod
+      << ",\"line_period_max\":" << frame.maxLinePeriod
+      << ",\"line_jitter\":" << lineJitter
+      << ",\"line_jitter_histogram\":{\"min\":" << -JITTER_RANGE << ",\"counts\":[";
+  for (size_t i = 0; i < frame.jitterHistogram.size(); i++) {
+    out << (i > 0 ? "," : "") << frame.jitterHistogram[i];
+  }
+  out << "]},\"hsync_width\":" << hSyncWidth
+      << ",\"vsync_width\":" << frame.vSyncWidth
+      << ",\"samples_per_pixel\":" << samplesPerPixel
+      << ",\"pixel_clock_hz\":" << pixelClock
+      << ",\"dropped_blocks\":" << frame.droppedBlocks
+      << ",\"channels\":[";
+  for (size_t i = 0; i < mChannels.size(); i++) {
+    out << (i > 0 ? "," : "") << "{\"channel\":" << static_cast<int>(mChannels[i])
+        << ",\"duty_cycle\":" << static_cast<double>(channelCounter.getHighCount(mChannels[i])) / dutyCycleDivisor
+        << ",\"edges\":" << channelCounter.getEdgeCount(mChannels[i]) << "}";
+  }
+  out << "]}\n";
+}
+
+// A single pixel is the shortest run of equal data: its length is either the integer part of the pixel period or one
+// more. Rare shorter runs (noise) are ignored. Only precise with at least 2 samples per pixel.
+template <typename T>
+auto SignalAnalyzer<T>::estimateSamplesPerPixel() const -> double {
+  const auto& histogram = frame.runLengthHistogram;
+  uint64_t runCount = 0;
+  for (size_t length = 1; length < MAX_RUN_LENGTH; length++) {
+    runCount += histogram[length];
+  }
+  for (size_t length = 1; length < MAX_RUN_LENGTH; length++) {
+    if (histogram[length] == 0 || histogram[length] * MIN_RUN_SHARE < runCount) {
+      continue;
+    }
+    const auto next = length > 1 ? histogram[length + 1] : 0;
+    return static_cast<double>(length * histogram[length] + (length + 1) * next) / static_cast<double>(histogram[length] + next);
+  }
+
+  return 0;
+}
+
+template class SignalAnalyzer<Sample>;
+template class SignalAnalyzer<WideSample>;
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "ChannelCounter.h"
+#include "CompositeSyncSeparator.h"
+#include "DataDispatcher.h"
+#include "TransitionDecoder.h"
+#include "VisualizerConfiguration.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+enum class AnalysisFormat {
+  Csv,
+  Json, // one object per line
+};
+
+// Signal metrics per frame instead of pictures (vidgrok analyze): frame and line periods, sync pulse widths, line
+// jitter, an estimate of the pixel clock and the duty cycle and edge count of every channel.
+// Works in a single pass in constant memory, so it can monitor a live signal continuously. Frames start at the end of
+// the vertical sync pulse and lines at the end of the horizontal sync pulse, like in FrameDecoder.
+// Blocks dropped by the dispatcher (live captures) are skipped in time, but no period or pulse width is measured
+// across them, and the frame reports how many there were.
+// T is the sample type (Sample or WideSample).
+template <typename T>
+class SignalAnalyzer final {
+public:
+  // outputPath "-" is stdout
+  SignalAnalyzer(
+    DataDispatcher<T>& dataDispatcher,
+    const VisualizerConfiguration& config,
+    const std::vector<uint8_t>& channels,
+    AnalysisFormat format,
+    const std::string& outputPath
+  );
+
+  // Main loop: Fetches new samples until the data source closes the channel.
+  auto run() -> void;
+
+  [[nodiscard]] auto getFrameCount() const -> uint64_t;
+
+  static constexpr long int JITTER_RANGE = 16;     // samples of line period change, larger changes share the outer buckets
+  static constexpr size_t MAX_RUN_LENGTH = 64;     // of data runs for the pixel clock estimate
+  static constexpr uint64_t MIN_RUN_SHARE = 100;   // runs of a length have to be at least 1/MIN_RUN_SHARE of all runs
+
+private:
+  struct FrameMetrics {
+    uint64_t start = 0;
+    uint64_t vSyncWidth = 0; // pulse before the frame
+    uint64_t lineCount = 0;
+    double linePeriodSum = 0;
+    double squaredLinePeriodSum = 0;
+    uint64_t minLinePeriod = 0;
+    uint64_t maxLinePeriod = 0;
+    uint64_t hSyncPulseCount = 0;
+    uint64_t hSyncWidthSum = 0;
+    std::array<uint64_t, 2 * JITTER_RANGE + 1> jitterHistogram = {}; // change of the line period to the previous line
+    std::array<uint64_t, MAX_RUN_LENGTH + 1> runLengthHistogram = {}; // samples with the same data
+    uint64_t droppedBlocks = 0;
+    uint64_t droppedSamples = 0;
+  };
+
+  auto analyze(std::span<const T> samples) -> void;
+  auto skipGap(const typename DataDispatcher<T>::Gap& gap) -> void;
+  auto horizontalSyncEnded() -> void;
+  auto verticalSyncEnded() -> void;
+  auto writeHeader() -> void;
+  auto writeFrame(uint64_t end) -> void;
+  [[nodiscard]] auto estimateSamplesPerPixel() const -> double;
+
+  DataDispatcher<T>& mDataDispatcher;
+  const VisualizerConfiguration& mConfig;
+  const std::vector<uint8_t> mChannels;
+  const AnalysisFormat mFormat;
+
+  std::unique_ptr<std::ofstream> fileStream;
+  std::ostream* output = nullptr;
+
+  const T vSyncChannelMask = 0;
+  const T hSyncChannelMask = 0;
+  const T dataChannelMask = 0;
+  TransitionDecoder<T> transitionDecoder; // runs end at sync and data transitions
+  CompositeSyncSeparator compositeSyncSeparator;
+  ChannelCounter<T> channelCounter;
+
+  FrameMetrics frame;
+  bool frameStarted = false; // samples before the first vertical sync don't form a frame
+  uint64_t frameCount = 0;
+  uint64_t position = 0; // samples analyzed or dropped so far
+  bool afterGap = false; // sync levels before the gap are unknown
+  bool previousVSyncActive = false;
+  bool previousHSyncActive = false;
+  uint64_t vSyncStart = 0;
+  uint64_t hSyncStart = 0;
+  bool vSyncStartKnown = false; // the pulse didn't start in a gap
+  bool hSyncStartKnown = false;
+  bool hasLineStart = false;
+  uint64_t lineStart = 0;
+  uint64_t previousLinePeriod = 0;
+  bool hasData = false;
+  T dataValue = 0;
+  uint64_t dataRunLength = 0;
+};
@@ -0,0 +1,174 @@
+#include "Statistics.h"
+#include <bit>
+#include <iomanip>
+#include <sstream>
+
+auto Histogram::add(uint64_t value) -> void {
+  const auto bucket = std::min(static_cast<size_t>(std::bit_width(value)), BUCKET_COUNT - 1);
+  buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+auto Histogram::snapshot() const -> std::array<uint64_t, BUCKET_COUNT> {
+  std::array<uint64_t, BUCKET_COUNT> values = {};
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    values[i] = buckets[i].load(std::memory_order_relaxed);
+  }
+
+  return values;
+}
+
+auto Statistics::snapshot() const -> StatisticsSnapshot {
+  const auto load = [](const std::atomic<uint64_t>& counter) { return counter.load(std::memory_order_relaxed); };
+
+  StatisticsSnapshot snapshot;
+  snapshot.time = std::chrono::steady_clock::now();
+  snapshot.packetCount = load(packetCount);
+  snapshot.packetBytes = load(packetBytes);
+  snapshot.packetSizes = packetSizes.snapshot();
+  snapshot.blockCount = load(blockCount);
+  snapshot.blockSizes = blockSizes.snapshot();
+  readDispatcher(snapshot);
+  snapshot.decodedSampleCount = load(decodedSampleCount);
+  snapshot.decodeNanoseconds = load(decodeNanoseconds);
+  snapshot.decodedFrameCount = load(decodedFrameCount);
+  snapshot.pacingSleepNanoseconds = load(pacingSleepNanoseconds);
+  snapshot.accumulateNanoseconds = load(accumulateNanoseconds);
+  snapshot.publishedFrameCount = load(publishedFrameCount);
+  snapshot.droppedFrameCount = load(droppedFrameCount);
+  snapshot.presentedFrameCount = load(presentedFrameCount);
+  snapshot.unchangedFrameCount = load(unchangedFrameCount);
+  snapshot.comparedTileCount = load(comparedTileCount);
+  snapshot.changedTileCount = load(changedTileCount);
+  snapshot.textureUploadNanoseconds = load(textureUploadNanoseconds);
+  snapshot.renderNanoseconds = load(renderNanoseconds);
+
+  return snapshot;
+}
+
+namespace {
+
+auto ratio(uint64_t numerator, uint64_t denominator) -> double {
+  return denominator ? static_cast<double>(numerator) / static_cast<double>(denominator) : 0;
+}
+
+// JSON object of the buckets counted in the interval, keyed by their lower bound
+auto histogramToJson(const std::array<uint64_t, Histogram::BUCKET_COUNT>& current, const std::array<uint64_t, Histogram::BUCKET_COUNT>& previous) -> std::string {
+  std::ostringstream json;
+  json << "{";
+  bool first = true;
+  for (size_t i = 0; i < current.size(); i++) {
+    const auto count = current[i] - previous[i];
+    if (count) {
+      json << (first ? "" : ",") << "\"" << (i ? (uint64_t(1) << (i - 1)) : 0) << "\":" << count;
+      first = false;
+    }
+  }
+  json << "}";
+
+  return json.str();
+}
+
+} // namespace
+
+auto Statistics::toJson(const StatisticsSnapshot& current, const StatisticsSnapshot& previous) -> std::string {
+  const auto intervalNanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(current.time - previous.time).count());
+  const auto packets = current.packetCount - previous.packetCount;
+  const auto samples = current.decodedSampleCount - previous.decodedSampleCount;
+  const auto seconds = static_cast<double>(intervalNanoseconds) / 1e9;
+
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(6)
+       << "{\"interval_s\":" << seconds
+       << ",\"packets\":" << packets
+       << ",\"packet_bytes\":" << current.packetBytes - previous.packetBytes
+       << ",\"packets_dropped\":" << current.droppedPacketCount - previous.droppedPacketCount
+       << ",\"packet_size_histogram\":" << histogramToJson(current.packetSizes, previous.packetSizes)
+       << ",\"blocks\":" << current.blockCount - previous.blockCount
+       << ",\"block_size_histogram\":" << histogramToJson(current.blockSizes, previous.blockSizes)
+       << ",\"buffer_occupancy\":" << current.bufferOccupancy
+       << ",\"buffer_high_water_mark\":" << current.bufferHighWaterMark
+       << ",\"buffer_capacity\":" << current.bufferCapacity
+       << ",\"buffer_allocations\":" << current.bufferAllocationCount - previous.bufferAllocationCount
+       << ",\"buffer_allocated_bytes\":" << current.bufferAllocatedBytes
+       << ",\"producer_wait_s\":" << static_cast<double>(current.producerWaitNanoseconds - previous.producerWaitNanoseconds) / 1e9
+       << ",\"consumer_wait_s\":" << static_cast<double>(current.consumerWaitNanoseconds - previous.consumerWaitNanoseconds) / 1e9
+       << ",\"samples\":" << samples
+       << ",\"decode_s\":" << static_cast<double>(current.decodeNanoseconds - previous.decodeNanoseconds) / 1e9
+       << ",\"decode_ns_per_sample\":" << ratio(current.decodeNanoseconds - previous.decodeNanoseconds, samples)
+       << ",\"frames_decoded\":" << current.decodedFrameCount - previous.decodedFrameCount
+       << ",\"frames_published\":" << current.publishedFrameCount - previous.publishedFrameCount
+       << ",\"frames_dropped\":" << current.droppedFrameCount - previous.droppedFrameCount
+       << ",\"frames_presented\":" << current.presentedFrameCount - previous.presentedFrameCount
+       << ",\"frames_unchanged\":" << current.unchangedFrameCount - previous.unchangedFrameCount
+       << ",\"changed_tile_ratio\":" << ratio(current.changedTileCount - previous.changedTileCount, current.comparedTileCount - previous.comparedTileCount)
+       << ",\"accumulate_s\":" << static_cast<double>(current.accumulateNanoseconds - previous.accumulateNanoseconds) / 1e9
+       << ",\"pacing_sleep_s\":" << static_cast<double>(current.pacingSleepNanoseconds - previous.pacingSleepNanoseconds) / 1e9
+       << ",\"texture_upload_s\":" << static_cast<double>(current.textureUploadNanoseconds - previous.textureUploadNanoseconds) / 1e9
+       << ",\"render_s\":" << static_cast<double>(current.renderNanoseconds - previous.renderNanoseconds) / 1e9
+       << "}";
+
+  return json.str();
+}
+
+auto Statistics::toText(const StatisticsSnapshot& current, const StatisticsSnapshot& previous) -> std::vector<std::string> {
+  const auto seconds = std::chrono::duration<double>(current.time - previous.time).count();
+  const auto perSecond = [seconds](uint64_t value) { return seconds > 0 ? static_cast<double>(value) / seconds : 0; };
+  const auto milliseconds = [](uint64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1e6; };
+  const auto packets = current.packetCount - previous.packetCount;
+  const auto blocks = current.blockCount - previous.blockCount;
+  const auto samples = current.decodedSampleCount - previous.decodedSampleCount;
+  const auto presented = current.presentedFrameCount - previous.presentedFrameCount;
+
+  std::vector<std::string> lines;
+  auto line = [&lines]() -> std::ostringstream {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1);
+    return stream;
+  };
+  auto stream = line();
+  stream << "PACKETS/S " << perSecond(packets) << "  AVG SIZE " << ratio(current.packetBytes - previous.packetBytes, packets) << " B  DROPPED " << current.droppedPacketCount;
+  lines.push_back(stream.str());
+  stream = line();
+  stream << "BLOCKS/S " << perSecond(blocks) << "  PACKETS/BLOCK " << ratio(packets, blocks);
+  lines.push_back(stream.str());
+  stream = line();
+  stream << "BUFFER " << current.bufferOccupancy << "/" << current.bufferCapacity << "  HIGH WATER " << current.bufferHighWaterMark
+         << "  ALLOCS/S " << perSecond(current.bufferAllocationCount - previous.bufferAllocationCount) << "  " << current.bufferAllocatedBytes / (1024 * 1024) << " MIB";
+  lines.push_back(stream.str());
+  stream = line();
+  stream << "WAIT MS/S  SOURCE " << milliseconds(static_cast<uint64_t>(perSecond(current.producerWaitNanoseconds - previous.producerWaitNanoseconds)))
+         << "  DECODER " << milliseconds(static_cast<uint64_t>(perSecond(current.consumerWaitNanoseconds - previous.consumerWaitNanoseconds)));
+  lines.push_back(stream.str());
+  stream = line();
+  stream << std::setprecision(2) << "DECODE " << perSecond(samples) / 1e6 << " MSAMPLES/S  " << ratio(current.decodeNanoseconds - previous.decodeNanoseconds, samples) << " NS/SAMPLE";
+  lines.push_back(stream.str());
+  stream = line();
+  stream << "FRAMES/S DECODED " << perSecond(current.decodedFrameCount - previous.decodedFrameCount) << "  SHOWN " << perSecond(presented) << "  DROPPED " << current.droppedFrameCount;
+  lines.push_back(stream.str());
+  stream = line();
+  stream << "TILES CHANGED " << 100 * ratio(current.changedTileCount - previous.changedTileCount, current.comparedTileCount - previous.comparedTileCount)
+         << " PCT  UNCHANGED FRAMES/S " << perSecond(current.unchangedFrameCount - previous.unchangedFrameCount);
+  lines.push_back(stream.str());
+  stream = line();
+  stream << std::setprecision(2) << "MS/FRAME UPLOAD " << ratio(current.textureUploadNanoseconds - previous.textureUploadNanoseconds, presented) / 1e6
+         << "  RENDER " << ratio(current.renderNanoseconds - previous.renderNanoseconds, presented) / 1e6
+         << "  ACCUMULATE " << ratio(current.accumulateNanoseconds - previous.accumulateNanoseconds, current.decodedFrameCount - previous.decodedFrameCount) / 1e6
+         << "  PACING SLEEP MS/S " << milliseconds(static_cast<uint64_t>(perSecond(current.pacingSleepNanoseconds - previous.pacingSleepNanoseconds)));
+  lines.push_back(stream.str());
+
+  return lines;
+}
+
+ScopedTimer::ScopedTimer(Statistics* statistics, std::atomic<uint64_t> Statistics::*counter) {
+  if (statistics) {
+    mCounter = &(statistics->*counter);
+    start = std::chrono::steady_clock::now();
+  }
+}
+
+ScopedTimer::~ScopedTimer() {
+  if (mCounter) {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    mCounter->fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Power-of-two buckets: bucket i counts values in [2^(i-1), 2^i)
+class Histogram final {
+public:
+  static constexpr size_t BUCKET_COUNT = 40;
+
+  auto add(uint64_t value) -> void;
+  [[nodiscard]] auto snapshot() const -> std::array<uint64_t, BUCKET_COUNT>;
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets = {};
+};
+
+// Copy of all counters at one point in time
+struct StatisticsSnapshot {
+  std::chrono::time_point<std::chrono::steady_clock> time;
+  uint64_t packetCount = 0;
+  uint64_t packetBytes = 0;
+  std::array<uint64_t, Histogram::BUCKET_COUNT> packetSizes = {};
+  uint64_t blockCount = 0;
+  std::array<uint64_t, Histogram::BUCKET_COUNT> blockSizes = {};
+  uint64_t droppedPacketCount = 0;
+  uint64_t bufferOccupancy = 0;
+  uint64_t bufferHighWaterMark = 0;
+  uint64_t bufferCapacity = 0;
+  uint64_t producerWaitNanoseconds = 0;
+  uint64_t consumerWaitNanoseconds = 0;
+  uint64_t bufferAllocationCount = 0;
+  uint64_t bufferAllocatedBytes = 0;
+  uint64_t decodedSampleCount = 0;
+  uint64_t decodeNanoseconds = 0;
+  uint64_t decodedFrameCount = 0;
+  uint64_t pacingSleepNanoseconds = 0;
+  uint64_t accumulateNanoseconds = 0;
+  uint64_t publishedFrameCount = 0;
+  uint64_t droppedFrameCount = 0;
+  uint64_t presentedFrameCount = 0;
+  uint64_t unchangedFrameCount = 0;
+  uint64_t comparedTileCount = 0;
+  uint64_t changedTileCount = 0;
+  uint64_t textureUploadNanoseconds = 0;
+  uint64_t renderNanoseconds = 0;
+};
+
+// Counters of the hot path. Components only update them when they have been given a Statistics instance,
+// so disabled instrumentation costs one pointer check.
+class Statistics final {
+public:
+  template <typename T>
+  explicit Statistics(const DataDispatcher<T>& dataDispatcher)
+    : readDispatcher([&dataDispatcher](StatisticsSnapshot& snapshot) {
+        snapshot.droppedPacketCount = dataDispatcher.getOverrunCount();
+        snapshot.bufferOccupancy = dataDispatcher.getOccupancy();
+        snapshot.bufferHighWaterMark = dataDispatcher.getHighWaterMark();
+        snapshot.bufferCapacity = dataDispatcher.getCapacity();
+        snapshot.producerWaitNanoseconds = dataDispatcher.getProducerWaitNanoseconds();
+        snapshot.consumerWaitNanoseconds = dataDispatcher.getConsumerWaitNanoseconds();
+        snapshot.bufferAllocationCount = dataDispatcher.getArena().getAllocationCount();
+        snapshot.bufferAllocatedBytes = dataDispatcher.getArena().getAllocatedBytes();
+      }) {
+  }
+
+  [[nodiscard]] auto snapshot() const -> StatisticsSnapshot;
+
+  // One JSON object describing the interval between two snapshots
+  [[nodiscard]] static auto toJson(const StatisticsSnapshot& current, const StatisticsSnapshot& previous) -> std::string;
+  // Human-readable summary of the interval between two snapshots (for the overlay)
+  [[nodiscard]] static auto toText(const StatisticsSnapshot& current, const StatisticsSnapshot& previous) -> std::vector<std::string>;
+
+  std::atomic<uint64_t> packetCount = 0;
+  std::atomic<uint64_t> packetBytes = 0;
+  Histogram packetSizes;
+  std::atomic<uint64_t> blockCount = 0; // coalesced packets handed to the decoder
+  Histogram blockSizes;
+  std::atomic<uint64_t> decodedSampleCount = 0;
+  std::atomic<uint64_t> decodeNanoseconds = 0;
+  std::atomic<uint64_t> decodedFrameCount = 0;
+  std::atomic<uint64_t> pacingSleepNanoseconds = 0;
+  std::atomic<uint64_t> accumulateNanoseconds = 0; // blending frames (persistence)
+  std::atomic<uint64_t> publishedFrameCount = 0;
+  std::atomic<uint64_t> droppedFrameCount = 0;
+  std::atomic<uint64_t> presentedFrameCount = 0;
+  std::atomic<uint64_t> unchangedFrameCount = 0; // skipped because identical to the previous frame
+  std::atomic<uint64_t> comparedTileCount = 0;
+  std::atomic<uint64_t> changedTileCount = 0;
+  std::atomic<uint64_t> textureUploadNanoseconds = 0;
+  std::atomic<uint64_t> renderNanoseconds = 0;
+
+private:
+  const std::function<void(StatisticsSnapshot&)> readDispatcher; // independent of the sample type
+};
+
+// Adds the lifetime of the timer to a counter (does nothing without Statistics instance)
+class ScopedTimer final {
+public:
+  ScopedTimer(Statistics* statistics, std::atomic<uint64_t> Statistics::*counter);
+  ~ScopedTimer();
+  ScopedTimer(const ScopedTimer&) = delete;
+  auto operator=(const ScopedTimer&) -> ScopedTimer& = delete;
+
+private:
+  std::atomic<uint64_t>* mCounter = nullptr;
+  std::chrono::time_point<std::chrono::steady_clock> start;
+};
@@ -0,0 +1,44 @@
+#include "StatisticsReporter.h"
+#include <iostream>
+#include <stdexcept>
+
+StatisticsReporter::StatisticsReporter(
+  const Statistics& statistics,
+  const std::string& path,
+  std::chrono::milliseconds interval
+) : mStatistics(statistics),
+    mInterval(interval),
+    output(&std::cerr),
+    previous(statistics.snapshot()) {
+  if (path != "-") {
+    file.open(path, std::ios::out | std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error("Unable to open statistics file " + path);
+    }
+    output = &file;
+  }
+  thread = std::thread([this]() { run(); });
+}
+
+StatisticsReporter::~StatisticsReporter() {
+  {
+    std::lock_guard lk(mutex);
+    stopRequested = true;
+  }
+  conditionVariable.notify_all();
+  thread.join();
+  report();
+}
+
+auto StatisticsReporter::run() -> void {
+  std::unique_lock lk(mutex);
+  while (!conditionVariable.wait_for(lk, mInterval, [this] { return stopRequested; })) {
+    report();
+  }
+}
+
+auto StatisticsReporter::report() -> void {
+  const auto current = mStatistics.snapshot();
+  *output << Statistics::toJson(current, previous) << std::endl; // flushed, so the file can be followed live
+  previous = current;
+}
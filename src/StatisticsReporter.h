@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Statistics.h"
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Writes the statistics of every interval as one JSON object per line (to a file or stderr with "-").
+// The last, possibly shorter interval is written when the reporter is destroyed.
+class StatisticsReporter final {
+public:
+  StatisticsReporter(
+    const Statistics& statistics,
+    const std::string& path,
+    std::chrono::milliseconds interval
+  );
+  ~StatisticsReporter();
+  StatisticsReporter(const StatisticsReporter&) = delete;
+  auto operator=(const StatisticsReporter&) -> StatisticsReporter& = delete;
+
+private:
+  auto run() -> void;
+  auto report() -> void;
+
+  const Statistics& mStatistics;
+  const std::chrono::milliseconds mInterval;
+  std::ofstream file;
+  std::ostream* output;
+  StatisticsSnapshot previous;
+
+  bool stopRequested = false;
+  std::mutex mutex;
+  std::condition_variable conditionVariable;
+  std::thread thread;
+};
@@ -0,0 +1,225 @@
+#include "StreamDecoder.h"
+#include "ThreadAffinity.h"
+#include <chrono>
+#include <cstddef>
+
+template <typename T>
+StreamDecoder<T>::StreamDecoder(
+  DataDispatcher<T>& dataDispatcher,
+  const VisualizerConfiguration& config,
+  Statistics* statistics
+) : StreamDecoder(&dataDispatcher, nullptr, config, statistics) {
+}
+
+template <typename T>
+StreamDecoder<T>::StreamDecoder(
+  CapturePlayer<T>& player,
+  const VisualizerConfiguration& config,
+  Statistics* statistics
+) : StreamDecoder(nullptr, &player, config, statistics) {
+}
+
+template <typename T>
+StreamDecoder<T>::StreamDecoder(
+  DataDispatcher<T>* dataDispatcher,
+  CapturePlayer<T>* player,
+  const VisualizerConfiguration& config,
+  Statistics* statistics
+) : mDataDispatcher(dataDispatcher),
+    mPlayer(player),
+    mConfig(config),
+    mStatistics(statistics),
+    frame(static_cast<size_t>(mConfig.width) * mConfig.height, 0),
+    frameDifference(mConfig.width, mConfig.height),
+    frameExchange(frame.size(), frameDifference.getTileCount()),
+    frameDecoder(mConfig, [this]() { frameCompleted(); }) {
+  frameDecoder.setTarget(frame.data());
+  if (mConfig.persistence != Persistence::Off) {
+    frameAccumulator.emplace(frame.size(), mConfig.persistence, mConfig.persistenceFrames);
+  }
+  if (mConfig.autoMode) {
+    videoModeDetector.emplace(mConfig);
+  }
+}
+
+template <typename T>
+StreamDecoder<T>::~StreamDecoder() {
+  if (decoderThread.joinable()) {
+    stop();
+    decoderThread.join();
+  }
+}
+
+template <typename T>
+auto StreamDecoder<T>::start(std::optional<unsigned int> core) -> void {
+  decoderThread = std::thread([this]() { decode(); });
+  if (core) {
+    pinThreadToCore(decoderThread, core.value());
+  }
+}
+
+template <typename T>
+auto StreamDecoder<T>::stop() -> void {
+  stopRequested.store(true);
+  if (mDataDispatcher) {
+    mDataDispatcher->close();
+  } else {
+    mPlayer->interrupt();
+  }
+}
+
+template <typename T>
+auto StreamDecoder<T>::join() -> void {
+  if (decoderThread.joinable()) {
+    decoderThread.join();
+  }
+  if (decoderException) {
+    std::rethrow_exception(decoderException);
+  }
+}
+
+// Decoder thread
+template <typename T>
+auto StreamDecoder<T>::decode() -> void {
+  try {
+    decodingStartedAt = std::chrono::steady_clock::now();
+    lastPublishedAt = decodingStartedAt;
+    if (mPlayer) {
+      play();
+    } else {
+      receive();
+    }
+    publish();
+  } catch (...) {
+    decoderException = std::current_exception();
+    if (mDataDispatcher) {
+      mDataDispatcher->close();
+    }
+  }
+  decodingFinished.store(true);
+}
+
+// Fetches new samples (if available) and decodes them.
+template <typename T>
+auto StreamDecoder<T>::receive() -> void {
+  while (!stopRequested.load()) {
+    auto optionalData = mDataDispatcher->get(std::chrono::milliseconds(250));
+    if (optionalData) {
+      {
+        ScopedTimer timer(mStatistics, &Statistics::decodeNanoseconds);
+        frameDecoder.decode(optionalData.value());
+      }
+      if (mStatistics) {
+        mStatistics->decodedSampleCount.fetch_add(optionalData->size(), std::memory_order_relaxed);
+      }
+      if (videoModeDetector) {
+        videoModeDetector->scan(optionalData.value());
+        changedVideoMode = videoModeDetector->takeChangedMode();
+      }
+      mDataDispatcher->clear();
+      if (changedVideoMode) {
+        break; // the dispatcher stays open for a decoder with the new mode
+      }
+      pace();
+    } else if (mDataDispatcher->isClosed()) {
+      break;
+    }
+
+    publishInProgress();
+  }
+}
+
+// Decodes the blocks chosen by the player, starting over where it seeks to.
+template <typename T>
+auto StreamDecoder<T>::play() -> void {
+  while (!stopRequested.load()) {
+    const auto block = mPlayer->nextBlock();
+    if (block.restart) {
+      frameDecoder.reset(block.previousSample);
+      positionOffset = block.position - frameDecoder.getDecodedSampleCount();
+    }
+    if (!block.samples.empty()) {
+      {
+        ScopedTimer timer(mStatistics, &Statistics::decodeNanoseconds);
+        frameDecoder.decode(block.samples);
+      }
+      if (mStatistics) {
+        mStatistics->decodedSampleCount.fetch_add(block.samples.size(), std::memory_order_relaxed);
+      }
+      ScopedTimer timer(mStatistics, &Statistics::pacingSleepNanoseconds);
+      mPlayer->pace(getStreamPosition());
+    }
+
+    publishInProgress();
+  }
+}
+
+// When not rendering synced, the frame in progress is shown regularly (also when packets are coming in slowly)
+template <typename T>
+auto StreamDecoder<T>::publishInProgress() -> void {
+  if (!mConfig.renderSynced && !frameAccumulator && std::chrono::steady_clock::now() >= lastPublishedAt + MINIMAL_RENDER_PAUSE) {
+    publish();
+  }
+}
+
+// Called by the decoder on vertical sync
+template <typename T>
+auto StreamDecoder<T>::frameCompleted() -> void {
+  if (mPlayer && !mPlayer->frameCompleted(getStreamPosition())) {
+    return;
+  }
+  if (mStatistics) {
+    mStatistics->decodedFrameCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (frameAccumulator) {
+    ScopedTimer timer(mStatistics, &Statistics::accumulateNanoseconds);
+    frameAccumulator->accumulate(frame);
+  }
+  if (mConfig.renderSynced || frameAccumulator) {
+    publish();
+  }
+}
+
+template <typename T>
+auto StreamDecoder<T>::publish() -> void {
+  const auto presentedFrame = getPresentedFrame();
+  const auto changedTiles = frameDifference.update(presentedFrame);
+  lastPublishedAt = std::chrono::steady_clock::now();
+  if (mStatistics) {
+    mStatistics->comparedTileCount.fetch_add(frameDifference.getTileCount(), std::memory_order_relaxed);
+    mStatistics->changedTileCount.fetch_add(changedTiles, std::memory_order_relaxed);
+  }
+  if (changedTiles == 0) {
+    if (mStatistics) {
+      mStatistics->unchangedFrameCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return; // nothing to present
+  }
+
+  frameExchange.publish(presentedFrame, frameDifference.getDirtyTiles());
+  if (mStatistics) {
+    mStatistics->publishedFrameCount.store(frameExchange.getPublishedFrameCount(), std::memory_order_relaxed);
+    mStatistics->droppedFrameCount.store(frameExchange.getDroppedFrameCount(), std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+auto StreamDecoder<T>::getPresentedFrame() const -> std::span<const Pixel> {
+  return frameAccumulator ? frameAccumulator->getFrame() : std::span<const Pixel>(frame);
+}
+
+template <typename T>
+auto StreamDecoder<T>::getStreamPosition() const -> uint64_t {
+  return positionOffset + frameDecoder.getDecodedSampleCount();
+}
+
+// Slow down decoding to match real time (important for recorded sessions)
+template <typename T>
+auto StreamDecoder<T>::pace() -> void {
+  const auto recordingDuration = std::chrono::duration<double>(static_cast<double>(frameDecoder.getDecodedSampleCount()) / static_cast<double>(mConfig.sampleRate));
+  ScopedTimer timer(mStatistics, &Statistics::pacingSleepNanoseconds);
+  std::this_thread::sleep_until(decodingStartedAt + std::chrono::duration_cast<std::chrono::nanoseconds>(recordingDuration));
+}
+
+template class StreamDecoder<Sample>;
+template class StreamDecoder<WideSample>;
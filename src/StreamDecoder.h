@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CapturePlayer.h"
+#include "DataDispatcher.h"
+#include "FrameAccumulator.h"
+#include "FrameDecoder.h"
+#include "FrameDifference.h"
+#include "FrameExchange.h"
+#include "Statistics.h"
+#include "VideoModeDetector.h"
+#include "VisualizerConfiguration.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Decodes one stream on its own thread into a CPU-side frame buffer and hands complete frames to the presenter.
+// Decoding is never blocked by presentation: frames are dropped when the display is too slow, frames without
+// changes are not handed over at all.
+// With persistence, only completed frames are blended into the presented image.
+// In auto mode, the sync timing is monitored and decoding stops when the video mode changes.
+// Instead of a dispatcher, samples can be taken from a capture player that controls the position and pacing.
+template <typename T>
+class StreamDecoder final {
+public:
+  StreamDecoder(
+    DataDispatcher<T>& dataDispatcher,
+    const VisualizerConfiguration& config,
+    Statistics* statistics = nullptr
+  );
+  StreamDecoder(
+    CapturePlayer<T>& player,
+    const VisualizerConfiguration& config,
+    Statistics* statistics = nullptr
+  );
+  ~StreamDecoder();
+  StreamDecoder(const StreamDecoder&) = delete;
+  auto operator=(const StreamDecoder&) -> StreamDecoder& = delete;
+
+  // Start the decoder thread, optionally pinned to a CPU core
+  auto start(std::optional<unsigned int> core = std::optional<unsigned int>()) -> void;
+  // Stop decoding (the data source is told by closing the dispatcher)
+  auto stop() -> void;
+  // Wait for the decoder thread. Rethrows its exception, if any.
+  auto join() -> void;
+
+  // To be called by presenter: Newest frame if a new one has been published since the last call.
+  auto acquire() -> std::optional<ExchangedFrame> {
+    return frameExchange.acquire();
+  }
+
+  // All samples have been decoded and the last frame has been published
+  [[nodiscard]] auto isFinished() const -> bool {
+    return decodingFinished.load();
+  }
+
+  [[nodiscard]] auto getSyncLock() const -> const SyncLock& {
+    return frameDecoder.getSyncLock();
+  }
+
+  // New video mode that made decoding stop (auto mode only, valid when finished)
+  [[nodiscard]] auto getChangedVideoMode() const -> const std::optional<VideoMode>& {
+    return changedVideoMode;
+  }
+
+  [[nodiscard]] auto getPlayer() const -> CapturePlayer<T>* {
+    return mPlayer;
+  }
+
+private:
+  StreamDecoder(
+    DataDispatcher<T>* dataDispatcher,
+    CapturePlayer<T>* player,
+    const VisualizerConfiguration& config,
+    Statistics* statistics
+  );
+
+  auto decode() -> void;
+  auto receive() -> void;
+  auto play() -> void;
+  inline auto publishInProgress() -> void;
+  inline auto frameCompleted() -> void;
+  inline auto publish() -> void;
+  [[nodiscard]] auto getPresentedFrame() const -> std::span<const Pixel>;
+  // Sample offset in the capture (player only)
+  [[nodiscard]] auto getStreamPosition() const -> uint64_t;
+  inline auto pace() -> void;
+
+  DataDispatcher<T>* mDataDispatcher;
+  CapturePlayer<T>* mPlayer;
+  const VisualizerConfiguration& mConfig;
+  Statistics* mStatistics;
+
+  std::vector<Pixel> frame; // written by decoder thread only
+  std::optional<FrameAccumulator> frameAccumulator; // used by decoder thread only
+  FrameDifference frameDifference;                 // used by decoder thread only
+  FrameExchange frameExchange;
+  FrameDecoder<T> frameDecoder;
+  std::optional<VideoModeDetector<T>> videoModeDetector;
+  std::optional<VideoMode> changedVideoMode;
+  std::thread decoderThread;
+
+  std::atomic<bool> stopRequested = false;
+  std::atomic<bool> decodingFinished = false;
+  std::exception_ptr decoderException;
+  uint64_t positionOffset = 0; // player: stream position - decoded sample count (changes on restarts)
+
+  std::chrono::time_point<std::chrono::steady_clock> decodingStartedAt;
+  std::chrono::time_point<std::chrono::steady_clock> lastPublishedAt;
+
+  const std::chrono::milliseconds MINIMAL_RENDER_PAUSE = std::chrono::milliseconds(20); // = 50 fps
+};
@@ -0,0 +1,64 @@
+#include "StreamRecorder.h"
+#include "SampleRecorder.h"
+#include <iostream>
+
+template <typename T>
+StreamRecorder<T>::StreamRecorder(
+  const std::string& path
+) : mPath(path),
+    dataDispatcher(SLOT_COUNT, DataDispatcher<T>::OverflowPolicy::Drop) {
+}
+
+template <typename T>
+StreamRecorder<T>::~StreamRecorder() {
+  stop();
+}
+
+template <typename T>
+auto StreamRecorder<T>::getDataDispatcher() -> DataDispatcher<T>& {
+  return dataDispatcher;
+}
+
+template <typename T>
+auto StreamRecorder<T>::start(
+  uint64_t sampleRate,
+  const std::vector<std::string>& channelNames,
+  uint8_t vSyncChannel,
+  bool invertVSync
+) -> void {
+  writer = std::make_unique<NativeCaptureWriter<T>>(mPath, sampleRate, channelNames, vSyncChannel, invertVSync);
+  writerThread = std::thread([this]() { record(); });
+}
+
+template <typename T>
+auto StreamRecorder<T>::stop() -> void {
+  dataDispatcher.close(); // no new blocks, queued ones are still written
+  if (writerThread.joinable()) {
+    writerThread.join();
+  }
+}
+
+template <typename T>
+auto StreamRecorder<T>::getDroppedBlockCount() const -> uint64_t {
+  return dataDispatcher.getOverrunCount();
+}
+
+template <typename T>
+auto StreamRecorder<T>::getRecordedSampleCount() const -> uint64_t {
+  return writer ? writer->getSampleCount() : 0;
+}
+
+// Writer thread: drains the dispatcher until it is closed and empty
+template <typename T>
+auto StreamRecorder<T>::record() -> void {
+  try {
+    SampleRecorder<T> recorder(dataDispatcher, *writer);
+    recorder.run();
+  } catch (std::exception& e) {
+    std::cerr << "Recording to " << mPath << " stopped: " << e.what() << std::endl;
+    dataDispatcher.close(); // the capture itself goes on
+  }
+}
+
+template class StreamRecorder<Sample>;
+template class StreamRecorder<WideSample>;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "NativeCaptureWriter.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes a copy of a live sample stream to a native capture file on its own thread.
+// The data source passes every packet to getDataDispatcher() in addition to the decoder. That dispatcher never
+// blocks: when the disk can't keep up, blocks are dropped (and counted) instead of stalling the capture.
+template <typename T>
+class StreamRecorder final {
+public:
+  explicit StreamRecorder(const std::string& path);
+  ~StreamRecorder();
+  StreamRecorder(const StreamRecorder&) = delete;
+  auto operator=(const StreamRecorder&) -> StreamRecorder& = delete;
+
+  auto getDataDispatcher() -> DataDispatcher<T>&;
+
+  // Start writing (the sample rate and channel names are known once the data source has been created)
+  auto start(uint64_t sampleRate, const std::vector<std::string>& channelNames, uint8_t vSyncChannel, bool invertVSync) -> void;
+  // Write the remaining blocks and finish the file
+  auto stop() -> void;
+
+  [[nodiscard]] auto getDroppedBlockCount() const -> uint64_t;
+  [[nodiscard]] auto getRecordedSampleCount() const -> uint64_t;
+
+private:
+  auto record() -> void;
+
+  const std::string mPath;
+  DataDispatcher<T> dataDispatcher;
+  std::unique_ptr<NativeCaptureWriter<T>> writer;
+  std::thread writerThread;
+
+  static constexpr size_t SLOT_COUNT = 256; // ~16 MiB of typical packets to bridge disk latency spikes
+};
@@ -0,0 +1,129 @@
+#include "SyncLock.h"
+#include <cmath>
+#include <sstream>
+
+auto SyncLock::horizontalEdge(uint64_t position) -> HorizontalEdge {
+  if (!hasLineStart) {
+    hasLineStart = true;
+    lastLineStart = position;
+    return HorizontalEdge::NewLine;
+  }
+
+  if (!lineLocked) {
+    learn(linePeriod, consistentLines, lineLocked, static_cast<double>(position - lastLineStart));
+    lastLineStart = position;
+    lastLineStartPredicted = false;
+    return HorizontalEdge::NewLine;
+  }
+
+  const double window = TOLERANCE * linePeriod;
+  const double lateError = static_cast<double>(position) - static_cast<double>(lastLineStart);
+  const double error = lateError - linePeriod;
+  HorizontalEdge result = HorizontalEdge::NewLine;
+  double phaseError = error;
+  if (lastLineStartPredicted && std::abs(lateError) <= window) {
+    // Edge of the line that has been started by prediction arrives late
+    result = HorizontalEdge::Realign;
+    phaseError = lateError;
+  } else if (std::abs(error) > window) {
+    // Either noise or the timing has changed (after enough unexpected edges the lock is given up)
+    if (++inconsistentLines < UNLOCK_THRESHOLD) {
+      rejectedPulseCount++;
+      return HorizontalEdge::Rejected;
+    }
+    lineLocked = false;
+    consistentLines = 0;
+    phaseError = 0;
+  }
+
+  inconsistentLines = 0;
+  squaredPhaseError += LOOP_GAIN * (phaseError * phaseError - squaredPhaseError);
+  linePeriod += LOOP_GAIN * phaseError;
+  lastLineStart = position;
+  lastLineStartPredicted = false;
+
+  return result;
+}
+
+auto SyncLock::verticalEdge(uint64_t position) -> bool {
+  if (!hasFrameStart) {
+    hasFrameStart = true;
+    lastFrameStart = position;
+    return true;
+  }
+
+  const double interval = static_cast<double>(position - lastFrameStart);
+  if (frameLocked && std::abs(interval - framePeriod) > TOLERANCE * framePeriod) {
+    if (++inconsistentFrames < UNLOCK_THRESHOLD) {
+      rejectedPulseCount++;
+      return false;
+    }
+    frameLocked = false;
+    consistentFrames = 0;
+  }
+  inconsistentFrames = 0;
+  learn(framePeriod, consistentFrames, frameLocked, interval);
+  lastFrameStart = position;
+
+  return true;
+}
+
+auto SyncLock::lineStartedByPrediction() -> void {
+  lastLineStart = getNextLineStart();
+  lastLineStartPredicted = true;
+  predictedLineCount++;
+}
+
+auto SyncLock::isLocked() const -> bool {
+  return lineLocked;
+}
+
+// Predicted start of the next line. A sync edge arriving shortly after it realigns the line.
+auto SyncLock::getNextLineStart() const -> uint64_t {
+  return lastLineStart + static_cast<uint64_t>(std::llround(linePeriod));
+}
+
+auto SyncLock::getLineLength() const -> double {
+  return linePeriod;
+}
+
+auto SyncLock::getLinesPerFrame() const -> double {
+  return linePeriod > 0 ? framePeriod / linePeriod : 0;
+}
+
+auto SyncLock::getJitter() const -> double {
+  return std::sqrt(squaredPhaseError);
+}
+
+auto SyncLock::getRejectedPulseCount() const -> uint64_t {
+  return rejectedPulseCount;
+}
+
+auto SyncLock::getPredictedLineCount() const -> uint64_t {
+  return predictedLineCount;
+}
+
+auto SyncLock::getSummary() const -> std::string {
+  std::ostringstream summary;
+  summary << "Sync lock: " << (lineLocked ? "locked" : "not locked")
+          << ", line length " << linePeriod << " samples"
+          << ", " << getLinesPerFrame() << " lines/frame"
+          << ", jitter " << getJitter() << " samples"
+          << ", " << rejectedPulseCount << " noise pulses rejected"
+          << ", " << predictedLineCount << " missing line syncs replaced";
+
+  return summary.str();
+}
+
+// Running period estimate; lock is reached after enough intervals close to the estimate
+auto SyncLock::learn(double& period, unsigned int& consistentIntervals, bool& locked, double interval) -> void {
+  if (period > 0 && std::abs(interval - period) <= TOLERANCE * period) {
+    period += (interval - period) / 4;
+    if (++consistentIntervals >= LOCK_THRESHOLD) {
+      locked = true;
+    }
+  } else {
+    period = interval;
+    consistentIntervals = 0;
+  }
+}
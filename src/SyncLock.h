@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Timing recovery (software PLL) for horizontal and vertical sync.
+// Learns line and frame period from the observed sync edges, predicts the next line start, rejects noise pulses
+// and keeps generating lines when sync pulses are missing (flywheel).
+class SyncLock final {
+public:
+  enum class HorizontalEdge {
+    Rejected, // noise pulse, to be ignored
+    NewLine,  // start a new line here
+    Realign,  // the line was already started by prediction, restart it here (phase correction)
+  };
+
+  // Sync edge at the given sample position of the stream
+  auto horizontalEdge(uint64_t position) -> HorizontalEdge;
+  // Returns false for noise pulses
+  auto verticalEdge(uint64_t position) -> bool;
+  // The decoder started a line at getNextLineStart() because no sync edge arrived
+  auto lineStartedByPrediction() -> void;
+
+  [[nodiscard]] auto isLocked() const -> bool;
+  [[nodiscard]] auto getNextLineStart() const -> uint64_t;
+  [[nodiscard]] auto getLineLength() const -> double;    // samples per line
+  [[nodiscard]] auto getLinesPerFrame() const -> double; // lines per frame
+  [[nodiscard]] auto getJitter() const -> double;        // RMS deviation of sync edges from prediction (samples)
+  [[nodiscard]] auto getRejectedPulseCount() const -> uint64_t;
+  [[nodiscard]] auto getPredictedLineCount() const -> uint64_t;
+  [[nodiscard]] auto getSummary() const -> std::string;
+
+private:
+  auto learn(double& period, unsigned int& consistentIntervals, bool& locked, double interval) -> void;
+
+  // horizontal
+  double linePeriod = 0;
+  uint64_t lastLineStart = 0;
+  bool lastLineStartPredicted = false;
+  bool hasLineStart = false;
+  bool lineLocked = false;
+  unsigned int consistentLines = 0;
+  unsigned int inconsistentLines = 0;
+  double squaredPhaseError = 0;
+
+  // vertical
+  double framePeriod = 0;
+  uint64_t lastFrameStart = 0;
+  bool hasFrameStart = false;
+  bool frameLocked = false;
+  unsigned int consistentFrames = 0;
+  unsigned int inconsistentFrames = 0;
+
+  uint64_t rejectedPulseCount = 0;
+  uint64_t predictedLineCount = 0;
+
+  static constexpr double TOLERANCE = 0.05;            // accepted deviation from the predicted edge (fraction of period)
+  static constexpr unsigned int LOCK_THRESHOLD = 16;   // consistent intervals needed for lock
+  static constexpr unsigned int UNLOCK_THRESHOLD = 16; // consecutive unexpected edges to give up lock (e.g. mode switch)
+  static constexpr double LOOP_GAIN = 1.0 / 16;        // how fast period follows the observed edges when locked
+};
@@ -0,0 +1,20 @@
+#include "ThreadAffinity.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+auto pinThreadToCore(std::thread& thread, unsigned int core) -> bool {
+#ifdef __linux__
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(core % std::max(1U, std::thread::hardware_concurrency()), &cpuSet);
+  return pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+  (void)thread;
+  (void)core;
+  return false;
+#endif
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <thread>
+
+// Restrict a thread to one CPU core (core numbers wrap around). Returns false when not supported by the platform.
+auto pinThreadToCore(std::thread& thread, unsigned int core) -> bool;
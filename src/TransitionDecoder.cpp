@@ -0,0 +1,65 @@
+#include "TransitionDecoder.h"
+#include <bit>
+#include <cstdint>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+template <typename T>
+TransitionDecoder<T>::TransitionDecoder(T mask) : mMask(mask) {
+}
+
+template <typename T>
+auto TransitionDecoder<T>::decode(std::span<const T> samples) -> std::span<const SampleRun<T>> {
+  runs.clear();
+  runStart = 0;
+  if (samples.empty()) {
+    return runs;
+  }
+
+  const size_t size = samples.size();
+  size_t i = 0; // samples[i] is compared to samples[i + 1]
+
+#ifdef __SSE2__
+  // Compare 16 bytes of neighbouring pairs at once; each cleared bit of the comparison mask is a transition.
+  // Wide samples set two bits per sample, only the lower one is evaluated.
+  constexpr size_t lanes = 16 / sizeof(T);
+  for (; i + lanes + 1 <= size; i += lanes) {
+    const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+    const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i + 1]));
+    uint32_t transitions = 0;
+    if constexpr (sizeof(T) == 1) {
+      const __m128i mask = _mm_set1_epi8(static_cast<char>(mMask));
+      transitions = static_cast<uint32_t>(~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(current, mask), _mm_and_si128(next, mask))) & 0xffff);
+    } else {
+      const __m128i mask = _mm_set1_epi16(static_cast<short>(mMask));
+      transitions = static_cast<uint32_t>(~_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(current, mask), _mm_and_si128(next, mask))) & 0x5555);
+    }
+    while (transitions) {
+      addTransition(samples, i + std::countr_zero(transitions) / sizeof(T));
+      transitions &= transitions - 1;
+    }
+  }
+#endif
+
+  for (; i + 1 < size; i++) {
+    if ((samples[i] & mMask) != (samples[i + 1] & mMask)) {
+      addTransition(samples, i);
+    }
+  }
+
+  runs.push_back(SampleRun<T>{samples[runStart], size - runStart});
+
+  return runs;
+}
+
+// Close the run ending at index (inclusive)
+template <typename T>
+auto TransitionDecoder<T>::addTransition(std::span<const T> samples, size_t index) -> void {
+  runs.push_back(SampleRun<T>{samples[runStart], index + 1 - runStart});
+  runStart = index + 1;
+}
+
+template class TransitionDecoder<Sample>;
+template class TransitionDecoder<WideSample>;
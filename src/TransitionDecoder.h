@@ -0,0 +1,31 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Sequence of consecutive samples sharing the same (masked) value
+template <typename T>
+struct SampleRun {
+  T value; // first sample of the run
+  size_t length;
+};
+
+// Splits sample blocks into runs of equal values so that consumers can handle transitions instead of single samples.
+template <typename T>
+class TransitionDecoder final {
+public:
+  // Only bits set in mask are compared; samples differing in other bits are merged into the same run.
+  explicit TransitionDecoder(T mask = static_cast<T>(~0));
+
+  // Returned runs stay valid until the next call.
+  auto decode(std::span<const T> samples) -> std::span<const SampleRun<T>>;
+
+private:
+  auto addTransition(std::span<const T> samples, size_t index) -> void;
+
+  const T mMask;
+  std::vector<SampleRun<T>> runs;
+  size_t runStart = 0;
+};
@@ -0,0 +1,308 @@
+#include "VideoModeDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+auto VideoMode::apply(VisualizerConfiguration& config) const -> void {
+  const long int factor = std::max(config.decimation, 1U);
+  config.invertHSync = invertHSync;
+  config.invertVSync = invertVSync;
+  config.cropLeft = activeLeft;
+  config.cropTop = activeTop;
+  if (config.linePixels > 0 && linePeriod > 0) {
+    config.width = static_cast<int>(std::max(1.0, std::ceil(static_cast<double>(activeWidth) * config.linePixels / linePeriod)));
+  } else {
+    config.width = static_cast<int>(std::max(1L, (activeWidth + factor - 1) / factor));
+  }
+  config.height = static_cast<int>(std::max(1L, activeHeight));
+}
+
+auto VideoMode::matches(const VideoMode& other) const -> bool {
+  const auto near = [](double a, double b) { return std::abs(a - b) <= 0.01 * std::max(a, b); };
+  const auto nearSamples = [](long int a, long int b) { return std::abs(a - b) <= 2; };
+
+  return near(linePeriod, other.linePeriod) && near(linesPerFrame, other.linesPerFrame)
+         && invertHSync == other.invertHSync && invertVSync == other.invertVSync
+         && nearSamples(activeLeft, other.activeLeft) && nearSamples(activeWidth, other.activeWidth)
+         && activeTop == other.activeTop && activeHeight == other.activeHeight;
+}
+
+auto VideoMode::toString(uint64_t sampleRate) const -> std::string {
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(1) << "line " << linePeriod << " samples";
+  if (sampleRate > 0) {
+    stream << " (" << linePeriod * 1e6 / static_cast<double>(sampleRate) << " us)";
+  }
+  stream << ", " << linesPerFrame << " lines/frame";
+  if (sampleRate > 0) {
+    stream << " (" << static_cast<double>(sampleRate) / (linePeriod * linesPerFrame) << " Hz)";
+  }
+  stream << ", hsync active " << (invertHSync ? "high" : "low") << ", vsync active " << (invertVSync ? "high" : "low")
+         << ", data in " << activeWidth << " samples x " << activeHeight << " lines from sample " << activeLeft << " of line " << activeTop;
+
+  return stream.str();
+}
+
+template <typename T>
+VideoModeDetector<T>::VideoModeDetector(const VisualizerConfiguration& config)
+  : mConfig(config),
+    vSyncChannelMask(static_cast<T>(1 << config.vSyncChannel)),
+    hSyncChannelMask(static_cast<T>(1 << config.hSyncChannel)),
+    dataChannelMask([&config]() {
+      unsigned int mask = 0;
+      for (unsigned int bit = 0; bit < config.colorDepth; bit++) {
+        mask |= 1U << (config.dataRedChannel - bit);
+        mask |= 1U << (config.dataGreenChannel - bit);
+        mask |= 1U << (config.dataBlueChannel - bit);
+      }
+      return static_cast<T>(mask);
+    }()),
+    syncTransitionDecoder(static_cast<T>(vSyncChannelMask | hSyncChannelMask)),
+    dataTransitionDecoder(static_cast<T>(vSyncChannelMask | hSyncChannelMask | dataChannelMask)) {
+}
+
+template <typename T>
+auto VideoModeDetector<T>::scan(std::span<const T> samples) -> void {
+  switch (stage) {
+    case Stage::Timing:
+      scanTiming(samples);
+      break;
+    case Stage::ActiveArea:
+      scanActiveArea(samples);
+      break;
+    case Stage::Monitoring:
+      scanMonitoring(samples);
+      break;
+  }
+  if (!samples.empty()) {
+    previousSample = samples.back();
+    hasPreviousSample = true;
+  }
+}
+
+template <typename T>
+auto VideoModeDetector<T>::isComplete() const -> bool {
+  return complete;
+}
+
+template <typename T>
+auto VideoModeDetector<T>::getVideoMode() const -> const VideoMode& {
+  return videoMode;
+}
+
+template <typename T>
+auto VideoModeDetector<T>::takeChangedMode() -> std::optional<VideoMode> {
+  if (!changed) {
+    return std::optional<VideoMode>();
+  }
+  changed = false;
+
+  return videoMode;
+}
+
+template <typename T>
+auto VideoModeDetector<T>::getAnalyzedSampleCount() const -> uint64_t {
+  return position - stageStart;
+}
+
+// Collect all sync edges and the time each sync channel is high
+template <typename T>
+auto VideoModeDetector<T>::scanTiming(std::span<const T> samples) -> void {
+  const T dataOff = mConfig.invertData ? dataChannelMask : 0;
+  T previous = previousSample;
+  bool hasPrevious = hasPreviousSample;
+  for (const auto& run : dataTransitionDecoder.decode(samples)) {
+    if (hasPrevious) {
+      if ((run.value ^ previous) & hSyncChannelMask && hSyncEdges[(run.value & hSyncChannelMask) ? 1 : 0].size() < MAX_LINE_EDGES) {
+        hSyncEdges[(run.value & hSyncChannelMask) ? 1 : 0].push_back(position);
+      }
+      if ((run.value ^ previous) & vSyncChannelMask) {
+        vSyncEdges[(run.value & vSyncChannelMask) ? 1 : 0].push_back(position);
+      }
+    }
+    if (run.value & hSyncChannelMask) {
+      hSyncHighSamples += run.length;
+    }
+    if (run.value & vSyncChannelMask) {
+      vSyncHighSamples += run.length;
+    }
+    if ((run.value & dataChannelMask) != dataOff) {
+      (run.value & hSyncChannelMask ? hSyncHighDataSamples : hSyncLowDataSamples) += run.length;
+      (run.value & vSyncChannelMask ? vSyncHighDataSamples : vSyncLowDataSamples) += run.length;
+    }
+    previous = run.value;
+    hasPrevious = true;
+    position += run.length;
+  }
+
+  const auto enough = [](const std::vector<uint64_t> (&edges)[2], size_t count) { return edges[0].size() >= count && edges[1].size() >= count; };
+  if (enough(vSyncEdges, TIMING_FRAMES) && enough(hSyncEdges, 2)) {
+    finishTiming();
+  }
+}
+
+// Sync pulses are the shorter level. Some machines provide blanking signals of about 50 % instead; then the
+// level without data is the active one. Lines and frames start where it ends (like in FrameDecoder).
+template <typename T>
+auto VideoModeDetector<T>::finishTiming() -> void {
+  const auto analyzedSamples = static_cast<double>(position - stageStart);
+  const auto isActiveHigh = [analyzedSamples](uint64_t highSamples, uint64_t highDataSamples, uint64_t lowDataSamples) {
+    const auto highFraction = static_cast<double>(highSamples) / analyzedSamples;
+    if (std::abs(highFraction - 0.5) < AMBIGUOUS_DUTY_CYCLE && highDataSamples != lowDataSamples) {
+      return highDataSamples < lowDataSamples;
+    }
+    return highFraction < 0.5;
+  };
+  previousMode = complete ? std::optional<VideoMode>(videoMode) : std::optional<VideoMode>();
+  videoMode.invertHSync = isActiveHigh(hSyncHighSamples, hSyncHighDataSamples, hSyncLowDataSamples);
+  videoMode.invertVSync = isActiveHigh(vSyncHighSamples, vSyncHighDataSamples, vSyncLowDataSamples);
+  hSyncActiveFraction = static_cast<double>(videoMode.invertHSync ? hSyncHighSamples : position - stageStart - hSyncHighSamples) / analyzedSamples;
+
+  const auto intervals = [](const std::vector<uint64_t>& edges) {
+    std::vector<uint64_t> result;
+    for (size_t i = 1; i < edges.size(); i++) {
+      result.push_back(edges[i] - edges[i - 1]);
+    }
+    return result;
+  };
+  // an inverted sync ends with a falling edge
+  videoMode.linePeriod = median(intervals(hSyncEdges[videoMode.invertHSync ? 0 : 1]));
+  const auto framePeriod = median(intervals(vSyncEdges[videoMode.invertVSync ? 0 : 1]));
+  videoMode.linesPerFrame = videoMode.linePeriod > 0 ? framePeriod / videoMode.linePeriod : 0;
+
+  stage = Stage::ActiveArea;
+  lineStart.reset();
+  frameStart.reset();
+  analyzedFrames = 0;
+  hasData = false;
+}
+
+// Bounding box of the data, in samples after the line start and lines after the frame start
+template <typename T>
+auto VideoModeDetector<T>::scanActiveArea(std::span<const T> samples) -> void {
+  const T dataOff = mConfig.invertData ? dataChannelMask : 0;
+  bool previousHSyncActive = videoMode.invertHSync == static_cast<bool>(previousSample & hSyncChannelMask);
+  bool previousVSyncActive = videoMode.invertVSync == static_cast<bool>(previousSample & vSyncChannelMask);
+  for (const auto& run : dataTransitionDecoder.decode(samples)) {
+    const bool hSyncActive = videoMode.invertHSync == static_cast<bool>(run.value & hSyncChannelMask);
+    const bool vSyncActive = videoMode.invertVSync == static_cast<bool>(run.value & vSyncChannelMask);
+    if (previousHSyncActive && !hSyncActive) {
+      lineStart = position;
+      line++;
+    }
+    if (previousVSyncActive && !vSyncActive) {
+      if (frameStart) {
+        analyzedFrames++;
+      }
+      frameStart = position;
+      lineStart = position;
+      line = 0;
+    }
+    const bool counted = frameStart && analyzedFrames < AREA_FRAMES;
+    if (counted && !hSyncActive && !vSyncActive && (run.value & dataChannelMask) != dataOff) {
+      const auto column = static_cast<long int>(position - lineStart.value());
+      const auto end = column + static_cast<long int>(run.length);
+      left = hasData ? std::min(left, column) : column;
+      right = hasData ? std::max(right, end) : end;
+      top = hasData ? std::min(top, line) : line;
+      bottom = hasData ? std::max(bottom, line + 1) : line + 1;
+      hasData = true;
+    }
+    previousHSyncActive = hSyncActive;
+    previousVSyncActive = vSyncActive;
+    position += run.length;
+  }
+
+  if (analyzedFrames < AREA_FRAMES) {
+    return;
+  }
+
+  // Without any data the whole frame is shown
+  videoMode.activeLeft = hasData ? left : 0;
+  videoMode.activeWidth = hasData ? right - left : std::lround(videoMode.linePeriod);
+  videoMode.activeTop = hasData ? top : 0;
+  videoMode.activeHeight = hasData ? bottom - top : std::lround(videoMode.linesPerFrame);
+  changed = previousMode && !previousMode->matches(videoMode);
+  complete = true;
+
+  stage = Stage::Monitoring;
+  unexpectedLines = 0;
+  unexpectedFrames = 0;
+  hSyncActiveSamples = 0;
+  frameSamples = 0;
+}
+
+// Only the sync edges are looked at: line and frame period have to match the detected mode, and sync pulses have
+// to stay the shorter level.
+template <typename T>
+auto VideoModeDetector<T>::scanMonitoring(std::span<const T> samples) -> void {
+  const auto deviates = [](double interval, double period) { return std::abs(interval - period) > TOLERANCE * period; };
+  bool previousHSyncActive = videoMode.invertHSync == static_cast<bool>(previousSample & hSyncChannelMask);
+  bool previousVSyncActive = videoMode.invertVSync == static_cast<bool>(previousSample & vSyncChannelMask);
+  for (const auto& run : syncTransitionDecoder.decode(samples)) {
+    const bool hSyncActive = videoMode.invertHSync == static_cast<bool>(run.value & hSyncChannelMask);
+    const bool vSyncActive = videoMode.invertVSync == static_cast<bool>(run.value & vSyncChannelMask);
+    if (previousHSyncActive && !hSyncActive) {
+      if (lineStart) {
+        unexpectedLines = deviates(static_cast<double>(position - lineStart.value()), videoMode.linePeriod) ? unexpectedLines + 1 : 0;
+      }
+      lineStart = position;
+    }
+    if (previousVSyncActive && !vSyncActive) {
+      if (frameStart) {
+        const auto activeFraction = static_cast<double>(hSyncActiveSamples) / static_cast<double>(std::max<uint64_t>(frameSamples, 1));
+        const bool polarityChanged = std::abs(activeFraction - hSyncActiveFraction) > POLARITY_CHANGE;
+        const bool periodChanged = deviates(static_cast<double>(position - frameStart.value()), videoMode.linePeriod * videoMode.linesPerFrame);
+        unexpectedFrames = polarityChanged ? CHANGE_FRAMES : (periodChanged ? unexpectedFrames + 1 : 0);
+      }
+      frameStart = position;
+      hSyncActiveSamples = 0;
+      frameSamples = 0;
+    }
+    if (hSyncActive) {
+      hSyncActiveSamples += run.length;
+    }
+    frameSamples += run.length;
+    previousHSyncActive = hSyncActive;
+    previousVSyncActive = vSyncActive;
+    position += run.length;
+  }
+
+  if (unexpectedLines >= CHANGE_LINES || unexpectedFrames >= CHANGE_FRAMES) {
+    restart();
+  }
+}
+
+// Start over with the timing (the previously detected mode stays available until the new one is complete)
+template <typename T>
+auto VideoModeDetector<T>::restart() -> void {
+  stage = Stage::Timing;
+  stageStart = position;
+  hSyncHighSamples = 0;
+  vSyncHighSamples = 0;
+  hSyncHighDataSamples = 0;
+  hSyncLowDataSamples = 0;
+  vSyncHighDataSamples = 0;
+  vSyncLowDataSamples = 0;
+  for (auto& edges : hSyncEdges) {
+    edges.clear();
+  }
+  for (auto& edges : vSyncEdges) {
+    edges.clear();
+  }
+}
+
+template <typename T>
+auto VideoModeDetector<T>::median(std::vector<uint64_t> intervals) -> double {
+  if (intervals.empty()) {
+    return 0;
+  }
+  const auto middle = intervals.begin() + static_cast<long int>(intervals.size() / 2);
+  std::nth_element(intervals.begin(), middle, intervals.end());
+
+  return static_cast<double>(*middle);
+}
+
+template class VideoModeDetector<Sample>;
+template class VideoModeDetector<WideSample>;
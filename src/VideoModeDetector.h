@@ -0,0 +1,116 @@
+#pragma once
+
+#include "DataDispatcher.h"
+#include "TransitionDecoder.h"
+#include "VisualizerConfiguration.h"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Video timing and visible area as measured from the signal
+struct VideoMode {
+  double linePeriod = 0; // samples
+  double linesPerFrame = 0;
+  bool invertHSync = false; // sync pulses are high
+  bool invertVSync = false;
+  long int activeLeft = 0;  // first sample with data after the horizontal sync
+  long int activeWidth = 0; // samples
+  long int activeTop = 0;   // first line with data after the vertical sync
+  long int activeHeight = 0;
+
+  // Set sync polarities, crop window and window size (respecting the decimation)
+  auto apply(VisualizerConfiguration& config) const -> void;
+  // Same timing and (almost) the same area
+  [[nodiscard]] auto matches(const VideoMode& other) const -> bool;
+  [[nodiscard]] auto toString(uint64_t sampleRate) const -> std::string;
+};
+
+// Detects the video mode from the first frames of a stream:
+// 1. timing: sync polarities (the shorter level, or the one without data) and the median line and frame period
+// 2. active area: bounding box of the data (outside of sync pulses) relative to the sync edges over some frames
+// Afterwards only the sync timing is monitored. When it changes (e.g. the machine switched its video mode), the
+// detection starts again with the following samples.
+template <typename T>
+class VideoModeDetector final {
+public:
+  explicit VideoModeDetector(const VisualizerConfiguration& config);
+
+  // Analyze the next block of the stream
+  auto scan(std::span<const T> samples) -> void;
+
+  // A mode has been detected (getVideoMode() is valid)
+  [[nodiscard]] auto isComplete() const -> bool;
+  [[nodiscard]] auto getVideoMode() const -> const VideoMode&;
+  // Mode detected after a change of the sync timing (returned only once)
+  auto takeChangedMode() -> std::optional<VideoMode>;
+  // Samples analyzed since the detection (re)started
+  [[nodiscard]] auto getAnalyzedSampleCount() const -> uint64_t;
+
+private:
+  enum class Stage {
+    Timing,
+    ActiveArea,
+    Monitoring,
+  };
+
+  auto scanTiming(std::span<const T> samples) -> void;
+  auto scanActiveArea(std::span<const T> samples) -> void;
+  auto scanMonitoring(std::span<const T> samples) -> void;
+  auto finishTiming() -> void;
+  auto restart() -> void;
+  [[nodiscard]] static auto median(std::vector<uint64_t> intervals) -> double;
+
+  const VisualizerConfiguration& mConfig;
+  const T vSyncChannelMask;
+  const T hSyncChannelMask;
+  const T dataChannelMask;
+  TransitionDecoder<T> syncTransitionDecoder;
+  TransitionDecoder<T> dataTransitionDecoder;
+
+  Stage stage = Stage::Timing;
+  VideoMode videoMode;
+  std::optional<VideoMode> previousMode; // while detecting again
+  double hSyncActiveFraction = 0;
+  bool complete = false;
+  bool changed = false;
+  uint64_t position = 0; // stream offset of the next sample
+  uint64_t stageStart = 0;
+  T previousSample = 0;
+  bool hasPreviousSample = false;
+
+  // timing
+  uint64_t hSyncHighSamples = 0;
+  uint64_t vSyncHighSamples = 0;
+  uint64_t hSyncHighDataSamples = 0; // data seen while the sync channel was high/low
+  uint64_t hSyncLowDataSamples = 0;
+  uint64_t vSyncHighDataSamples = 0;
+  uint64_t vSyncLowDataSamples = 0;
+  std::vector<uint64_t> hSyncEdges[2]; // falling, rising
+  std::vector<uint64_t> vSyncEdges[2];
+
+  // active area and monitoring
+  std::optional<uint64_t> lineStart;
+  std::optional<uint64_t> frameStart;
+  long int line = 0;
+  unsigned int analyzedFrames = 0;
+  long int left = 0;
+  long int right = 0;
+  long int top = 0;
+  long int bottom = 0;
+  bool hasData = false;
+  unsigned int unexpectedLines = 0;
+  unsigned int unexpectedFrames = 0;
+  uint64_t hSyncActiveSamples = 0; // of the current frame
+  uint64_t frameSamples = 0;
+
+  static constexpr size_t TIMING_FRAMES = 4;       // vertical sync edges needed for the timing
+  static constexpr size_t MAX_LINE_EDGES = 4096;   // enough for the median
+  static constexpr unsigned int AREA_FRAMES = 3;   // frames scanned for data
+  static constexpr double TOLERANCE = 0.05;        // accepted deviation of the monitored periods
+  static constexpr double AMBIGUOUS_DUTY_CYCLE = 0.1; // sync channels this close to 50 % high are blanking signals
+  static constexpr double POLARITY_CHANGE = 0.25;     // deviation of the horizontal sync duty cycle within a frame
+  static constexpr unsigned int CHANGE_LINES = 64; // consecutive unexpected lines until the mode is considered changed
+  static constexpr unsigned int CHANGE_FRAMES = 2; // consecutive unexpected frames until the mode is considered changed
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// How completed frames are combined (see FrameAccumulator)
+enum class Persistence {
+  Off,
+  Decay,
+  Average,
+  MaxHold,
+};
+
+// Default values should be OK for PAL video
+struct VisualizerConfiguration {
+  int width = 800;
+  int height = 330;
+  uint8_t vSyncChannel = 0;
+  uint8_t hSyncChannel = 1;
+  uint8_t dataRedChannel = 2;
+  uint8_t dataGreenChannel = 2;
+  uint8_t dataBlueChannel = 2;
+  unsigned int decimation = 1; // samples per pixel (horizontally)
+  bool boxFilter = false;       // average the samples of a pixel instead of picking the first one
+  unsigned int linePixels = 0;  // > 0: resample the line period to this many pixels (instead of decimation)
+  long int cropLeft = 0;        // samples after horizontal sync that are skipped
+  long int cropTop = 0;         // lines after vertical sync that are skipped
+  uint8_t colorDepth = 1; // bits per color component: data channels are the most significant bit, the next lower channels follow
+  bool invertData = false;
+  bool invertVSync = false;
+  bool invertHSync = false;
+  bool disableVSync = false;
+  bool disableHSync = false;
+  bool compositeSync = false; // horizontal sync channel carries composite sync, vertical sync is separated from it
+  bool highlightVSync = false;
+  bool highlightHSync = false;
+  bool renderHiddenData = false;
+  bool renderSynced = false;
+  bool syncLock = false;
+  Persistence persistence = Persistence::Off;
+  unsigned int persistenceFrames = 4; // time constant of the decay or number of averaged frames
+  bool autoMode = false; // detect sync polarities, crop window and size from the signal (see VideoModeDetector)
+  bool headless = false;
+  std::string outputPath; // frame output in headless mode
+  bool skipUnchangedFrames = false; // headless mode: don't write frames identical to the previous one
+  unsigned int decodeThreads = 1; // > 1: decode recorded sessions frame-parallel (headless mode only)
+  uint64_t sampleRate = 0; // not configurable via command line arguments
+};
@@ -0,0 +1,162 @@
+#include "ZoomView.h"
+#include <algorithm>
+
+template <typename T>
+ZoomView<T>::ZoomView(
+  std::span<const T> samples,
+  const SamplePyramid<T>& pyramid,
+  const FrameIndex<T>& frameIndex,
+  const VisualizerConfiguration& config
+) : mSamples(samples),
+    mPyramid(pyramid),
+    mFrameIndex(frameIndex),
+    mConfig(config),
+    pixelConverter(config),
+    hSyncChannelMask(static_cast<T>(1 << mConfig.hSyncChannel)),
+    firstLine(mConfig.cropTop),
+    left(static_cast<double>(mConfig.cropLeft)),
+    samplesPerPixel(std::max(mConfig.decimation, 1U)) {
+  showFrame(0);
+}
+
+template <typename T>
+auto ZoomView<T>::render(std::span<Pixel> pixels) -> void {
+  // The frame index may still be growing: the end of the last frame becomes known
+  if (frame + 1 < mFrameIndex.getFrameCount() && frameEnd != mFrameIndex.getFrameStart(frame + 1).value()) {
+    frameEnd = mFrameIndex.getFrameStart(frame + 1).value();
+    std::erase_if(lineStarts, [this](uint64_t lineStart) { return lineStart >= frameEnd; });
+    searchPosition = std::min(searchPosition, frameEnd);
+    allLinesFound = searchPosition >= frameEnd;
+  }
+
+  const auto width = static_cast<size_t>(mConfig.width);
+  rowSamples.resize(width);
+  rowPixels.resize(width);
+  rowVisible.resize(width);
+  for (int row = 0; row < mConfig.height; row++) {
+    auto* target = pixels.data() + static_cast<size_t>(row) * width;
+    if (row % rowsPerLine != 0) {
+      std::copy_n(target - width, width, target);
+      continue;
+    }
+    const long int line = firstLine + row / rowsPerLine;
+    findLines(static_cast<size_t>(line) + 2);
+    if (static_cast<size_t>(line) >= lineStarts.size()) {
+      std::fill_n(target, width, 0);
+      continue;
+    }
+
+    const auto lineStart = lineStarts[static_cast<size_t>(line)];
+    const auto lineEnd = getLineEnd(static_cast<size_t>(line));
+    for (size_t x = 0; x < width; x++) {
+      const double from = static_cast<double>(lineStart) + left + static_cast<double>(x) * samplesPerPixel;
+      const auto first = static_cast<uint64_t>(from);
+      rowVisible[x] = first < lineEnd;
+      if (!rowVisible[x]) {
+        rowSamples[x] = 0;
+      } else if (samplesPerPixel <= 1) {
+        rowSamples[x] = mSamples[first];
+      } else {
+        const auto last = std::clamp(static_cast<uint64_t>(from + samplesPerPixel), first + 1, lineEnd);
+        const auto summary = mPyramid.summarize(first, last);
+        rowSamples[x] = showAll ? summary.all : summary.any;
+      }
+    }
+    pixelConverter.convert(rowSamples, rowPixels.data());
+    for (size_t x = 0; x < width; x++) {
+      target[x] = rowVisible[x] ? rowPixels[x] : 0;
+    }
+  }
+}
+
+// Without frame index (e.g. no vertical sync), the whole capture is one frame.
+template <typename T>
+auto ZoomView<T>::showFrame(size_t newFrame) -> void {
+  const auto frameCount = mFrameIndex.getFrameCount();
+  frame = frameCount == 0 ? 0 : std::min(newFrame, frameCount - 1);
+  frameStart = frameCount == 0 ? 0 : mFrameIndex.getFrameStart(frame).value();
+  frameEnd = frame + 1 < frameCount ? mFrameIndex.getFrameStart(frame + 1).value() : mSamples.size();
+  lineStarts.assign(1, frameStart);
+  searchPosition = frameStart;
+  allLinesFound = frameStart >= frameEnd;
+}
+
+template <typename T>
+auto ZoomView<T>::pan(long int columns) -> void {
+  left = std::max(0.0, left + static_cast<double>(columns) * samplesPerPixel);
+}
+
+template <typename T>
+auto ZoomView<T>::scroll(long int rows) -> void {
+  const long int lines = rows / rowsPerLine != 0 ? rows / rowsPerLine : (rows > 0 ? 1 : -1);
+  firstLine = std::max(0L, firstLine + lines);
+  findLines(static_cast<size_t>(firstLine) + 1);
+  firstLine = std::min(firstLine, static_cast<long int>(lineStarts.size()) - 1);
+}
+
+template <typename T>
+auto ZoomView<T>::zoom(bool in) -> void {
+  const double center = left + mConfig.width / 2.0 * samplesPerPixel;
+  const double maxSamplesPerPixel = std::max(1.0, static_cast<double>(mSamples.size()) / mConfig.width);
+  samplesPerPixel = std::clamp(in ? samplesPerPixel / 2 : samplesPerPixel * 2, MIN_SAMPLES_PER_PIXEL, maxSamplesPerPixel);
+  left = std::max(0.0, center - mConfig.width / 2.0 * samplesPerPixel);
+}
+
+template <typename T>
+auto ZoomView<T>::zoomLines(bool in) -> void {
+  rowsPerLine = in ? std::min(rowsPerLine * 2, MAX_ROWS_PER_LINE) : std::max(rowsPerLine / 2, 1);
+}
+
+template <typename T>
+auto ZoomView<T>::toggleSummary() -> void {
+  showAll = !showAll;
+}
+
+// The first line is usually incomplete (it starts at the end of the vertical sync), so the length is taken from the
+// second one.
+template <typename T>
+auto ZoomView<T>::reset() -> void {
+  findLines(3);
+  const auto lineLength = lineStarts.size() > 2 ? lineStarts[2] - lineStarts[1] : frameEnd - frameStart;
+  samplesPerPixel = std::max(MIN_SAMPLES_PER_PIXEL, static_cast<double>(lineLength) / mConfig.width);
+  left = 0;
+  firstLine = 0;
+  rowsPerLine = 1;
+}
+
+// Line starts are the ends of the horizontal sync pulses, like in FrameDecoder. The pyramid skips from edge to edge.
+// Without horizontal sync, lines have the width of the window (times the decimation).
+template <typename T>
+auto ZoomView<T>::findLines(size_t lineCount) -> void {
+  while (lineStarts.size() < lineCount && !allLinesFound) {
+    if (mConfig.disableHSync) {
+      const auto next = lineStarts.back() + static_cast<uint64_t>(mConfig.width) * std::max(mConfig.decimation, 1U);
+      allLinesFound = next >= frameEnd;
+      if (!allLinesFound) {
+        lineStarts.push_back(next);
+      }
+      continue;
+    }
+
+    const T sample = mSamples[searchPosition];
+    const bool hSyncActive = mConfig.invertHSync == static_cast<bool>(sample & hSyncChannelMask);
+    const auto edge = mPyramid.findChange(searchPosition, frameEnd, hSyncChannelMask, sample);
+    if (edge >= frameEnd) {
+      allLinesFound = true;
+      searchPosition = frameEnd;
+      break;
+    }
+    if (hSyncActive) {
+      lineStarts.push_back(edge);
+    }
+    searchPosition = edge;
+  }
+}
+
+template <typename T>
+auto ZoomView<T>::getLineEnd(size_t line) const -> uint64_t {
+  return line + 1 < lineStarts.size() ? lineStarts[line + 1] : frameEnd;
+}
+
+template class ZoomView<Sample>;
+template class ZoomView<WideSample>;
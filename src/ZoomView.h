@@ -0,0 +1,94 @@
+#pragma once
+
+#include "FrameIndex.h"
+#include "PixelConverter.h"
+#include "SamplePyramid.h"
+#include "SdlWrapper.h"
+#include "VisualizerConfiguration.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Zoomable picture of one frame of a recorded capture: the view shows the lines from firstLine on (each repeated on
+// rowsPerLine rows), and from left samples after the start of the line on, samplesPerPixel samples per pixel.
+// Only the samples of the visible area are looked at. A pixel covering several samples shows which channels are set
+// in any (or, toggled, in all) of them, taken from the SamplePyramid, so a short pulse never disappears when zoomed
+// out. The line starts (ends of the horizontal sync pulses) are found through the pyramid, too.
+// T is the sample type (Sample or WideSample).
+template <typename T>
+class ZoomView final {
+public:
+  ZoomView(
+    std::span<const T> samples,
+    const SamplePyramid<T>& pyramid,
+    const FrameIndex<T>& frameIndex,
+    const VisualizerConfiguration& config
+  );
+
+  // Draw the view into a frame of config.width * config.height pixels
+  auto render(std::span<Pixel> pixels) -> void;
+
+  auto showFrame(size_t frame) -> void;
+  // Move by a number of pixels (columns) or rows
+  auto pan(long int columns) -> void;
+  auto scroll(long int rows) -> void;
+  // Halve/double the samples per pixel (at the center of the view)
+  auto zoom(bool in) -> void;
+  // Double/halve the rows per line
+  auto zoomLines(bool in) -> void;
+  auto toggleSummary() -> void;
+  // Whole line in the view, from the first line on
+  auto reset() -> void;
+
+  [[nodiscard]] auto getFrame() const -> size_t {
+    return frame;
+  }
+  [[nodiscard]] auto getFirstLine() const -> long int {
+    return firstLine;
+  }
+  [[nodiscard]] auto getLeft() const -> double {
+    return left;
+  }
+  [[nodiscard]] auto getSamplesPerPixel() const -> double {
+    return samplesPerPixel;
+  }
+  [[nodiscard]] auto getRowsPerLine() const -> int {
+    return rowsPerLine;
+  }
+  [[nodiscard]] auto isShowingAll() const -> bool {
+    return showAll;
+  }
+
+  static constexpr double MIN_SAMPLES_PER_PIXEL = 1.0 / 16;
+  static constexpr int MAX_ROWS_PER_LINE = 16;
+
+private:
+  // Find the line starts of the current frame up to the given line (or to the end of the frame)
+  auto findLines(size_t lineCount) -> void;
+  [[nodiscard]] auto getLineEnd(size_t line) const -> uint64_t;
+
+  const std::span<const T> mSamples;
+  const SamplePyramid<T>& mPyramid;
+  const FrameIndex<T>& mFrameIndex;
+  const VisualizerConfiguration& mConfig;
+  PixelConverter<T> pixelConverter;
+  const T hSyncChannelMask;
+
+  size_t frame = 0;
+  uint64_t frameStart = 0;
+  uint64_t frameEnd = 0;
+  std::vector<uint64_t> lineStarts; // of the current frame, found so far
+  uint64_t searchPosition = 0;      // where finding line starts continues
+  bool allLinesFound = false;
+
+  long int firstLine = 0;
+  double left = 0; // samples
+  double samplesPerPixel = 1;
+  int rowsPerLine = 1;
+  bool showAll = false; // show the channels set in all samples of a pixel instead of in any
+
+  std::vector<T> rowSamples;    // scratch buffers, capacity is reused
+  std::vector<Pixel> rowPixels;
+  std::vector<uint8_t> rowVisible;
+};
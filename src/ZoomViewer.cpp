@@ -0,0 +1,142 @@
+#include "ZoomViewer.h"
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+template <typename T>
+ZoomViewer<T>::ZoomViewer(
+  std::span<const T> samples,
+  const SamplePyramid<T>& pyramid,
+  const FrameIndex<T>& frameIndex,
+  const VisualizerConfiguration& config
+) : mFrameIndex(frameIndex),
+    mConfig(config),
+    view(samples, pyramid, frameIndex, config),
+    frame(static_cast<size_t>(mConfig.width) * mConfig.height, 0),
+    sdlWrapper(mConfig.width, mConfig.height, "vidgrok") {
+}
+
+template <typename T>
+auto ZoomViewer<T>::run(size_t startFrame) -> void {
+  if (startFrame > 0) {
+    pendingFrame = startFrame;
+  }
+  bool changed = true;
+  auto lastRenderedAt = std::chrono::steady_clock::now();
+  while (true) {
+    const auto now = std::chrono::steady_clock::now();
+    changed |= showPendingFrame();
+    // While the frame index is being built, the end of the shown frame may still become known
+    if (changed || (!mFrameIndex.isComplete() && now >= lastRenderedAt + WINDOW_REFRESH_INTERVAL)) {
+      view.render(frame);
+      sdlWrapper.updateTexture(frame);
+      updateTitle();
+    }
+    // Re-render without change from time to time to keep the window content intact
+    if (changed || now >= lastRenderedAt + WINDOW_REFRESH_INTERVAL) {
+      sdlWrapper.render();
+      lastRenderedAt = now;
+    }
+
+    const auto events = sdlWrapper.pollEvents();
+    if (events.quit) {
+      break;
+    }
+    changed = false;
+    for (const auto key : events.pressedKeys) {
+      changed |= control(key);
+    }
+    std::this_thread::sleep_for(PRESENTER_POLL_INTERVAL);
+  }
+}
+
+// Like seekable playback, a frame that is not indexed yet is shown as soon as it is. Frames beyond the end of the
+// capture are clamped to the last one.
+template <typename T>
+auto ZoomViewer<T>::showPendingFrame() -> bool {
+  if (!pendingFrame) {
+    return false;
+  }
+  const auto frameCount = mFrameIndex.getFrameCount();
+  if (pendingFrame.value() >= frameCount && !mFrameIndex.isComplete()) {
+    return false;
+  }
+  if (pendingFrame.value() >= frameCount) {
+    std::cerr << "Warning: Frame " << pendingFrame.value() << " is beyond the end of the capture (" << frameCount << " frames)." << std::endl;
+  }
+  view.showFrame(pendingFrame.value());
+  pendingFrame.reset();
+
+  return true;
+}
+
+template <typename T>
+auto ZoomViewer<T>::control(SDL_Keycode key) -> bool {
+  switch (key) {
+    case SDLK_LEFT:
+      view.pan(-mConfig.width / 4);
+      break;
+    case SDLK_RIGHT:
+      view.pan(mConfig.width / 4);
+      break;
+    case SDLK_UP:
+      view.scroll(-SCROLL_ROWS);
+      break;
+    case SDLK_DOWN:
+      view.scroll(SCROLL_ROWS);
+      break;
+    case SDLK_PLUS:
+    case SDLK_KP_PLUS:
+    case SDLK_EQUALS: // plus without shift on many layouts
+      view.zoom(true);
+      break;
+    case SDLK_MINUS:
+    case SDLK_KP_MINUS:
+      view.zoom(false);
+      break;
+    case SDLK_RIGHTBRACKET:
+      view.zoomLines(true);
+      break;
+    case SDLK_LEFTBRACKET:
+      view.zoomLines(false);
+      break;
+    case SDLK_PAGEUP:
+      pendingFrame.reset();
+      if (view.getFrame() > 0) {
+        view.showFrame(view.getFrame() - 1);
+      }
+      break;
+    case SDLK_PAGEDOWN:
+      pendingFrame.reset();
+      view.showFrame(view.getFrame() + 1);
+      break;
+    case SDLK_m:
+      view.toggleSummary();
+      break;
+    case SDLK_HOME:
+      view.reset();
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+template <typename T>
+auto ZoomViewer<T>::updateTitle() -> void {
+  std::ostringstream status;
+  status << "vidgrok - FRAME " << view.getFrame() << "/" << mFrameIndex.getFrameCount() << (mFrameIndex.isComplete() ? "" : " INDEXING");
+  if (pendingFrame) {
+    status << " WAITING FOR " << pendingFrame.value();
+  }
+  status << " LINE " << view.getFirstLine() << " SAMPLE " << static_cast<uint64_t>(view.getLeft());
+  status << " " << view.getSamplesPerPixel() << " SAMPLES/PIXEL " << (view.isShowingAll() ? "ALL" : "ANY");
+  if (status.str() != title) {
+    title = status.str();
+    sdlWrapper.setTitle(title);
+  }
+}
+
+template class ZoomViewer<Sample>;
+template class ZoomViewer<WideSample>;
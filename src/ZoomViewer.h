@@ -0,0 +1,48 @@
+#pragma once
+
+#include "FrameIndex.h"
+#include "SamplePyramid.h"
+#include "SdlWrapper.h"
+#include "VisualizerConfiguration.h"
+#include "ZoomView.h"
+#include <chrono>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Window of a ZoomView: arrows pan and scroll, +/- zoom the samples, [/] the lines, page up/down change the frame,
+// M toggles between channels set in any and in all samples of a pixel, home shows the whole line.
+// The picture is only rendered again after a change.
+template <typename T>
+class ZoomViewer final {
+public:
+  ZoomViewer(
+    std::span<const T> samples,
+    const SamplePyramid<T>& pyramid,
+    const FrameIndex<T>& frameIndex,
+    const VisualizerConfiguration& config
+  );
+
+  // Main loop: Shows the view until the window is closed.
+  auto run(size_t startFrame) -> void;
+
+private:
+  // Shows the frame requested by --start-frame once it is indexed, returns true when the view changed
+  auto showPendingFrame() -> bool;
+  // Returns true when the view has changed
+  auto control(SDL_Keycode key) -> bool;
+  auto updateTitle() -> void;
+
+  const FrameIndex<T>& mFrameIndex;
+  const VisualizerConfiguration& mConfig;
+  ZoomView<T> view;
+  std::vector<Pixel> frame;
+  SdlWrapper sdlWrapper;
+  std::string title;
+  std::optional<size_t> pendingFrame; // requested, but not indexed yet
+
+  const std::chrono::milliseconds PRESENTER_POLL_INTERVAL = std::chrono::milliseconds(4);
+  const std::chrono::milliseconds WINDOW_REFRESH_INTERVAL = std::chrono::milliseconds(250);
+  const long int SCROLL_ROWS = 16; // up/down
+};